@@ -9,9 +9,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <functional>
 #include <string>
+#include <type_traits>
+
+#include "inplaceFunctionIf.h"
+#include "futureIf.h"
 
 namespace UtilsFramework
 {
@@ -38,7 +42,7 @@ namespace V1
 *   // And you want to pass an argument such as a bool "flag" to AO as well
 *   YourClass *obj = ...
 *   auto function = std::bind(&YourClass::functionAbc, obj, flag);
-*   ao->executeFunction();
+*   ao->executeFunction(std::move(function));
 * </code>
 *
 * Note that: in asynchronous context, the function that is passed to AO must have void return type.
@@ -56,6 +60,64 @@ public:
         Fifo        // Respectively SCHED_FIFO.
     };
 
+    /*! @brief Functions executed by the AO thread. They are stored inline without any heap allocation and are
+    * move-only, see InplaceFunction. Lambdas can be given directly, an AOFunc variable has to be given with std::move(). */
+    using AOFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void()>;
+
+    /*! @brief Priority levels of the functions given to executeFunction(). Each level has its own queue, see
+    * setPriorityWeights() for how they are serviced. Functions of the same level are executed in FIFO order. */
+    enum class Priority : uint8_t
+    {
+        Urgent,     // Health checks, control tasks,... which must jump ahead of queued bulk work.
+        Normal,     // Default level.
+        Background  // Bulk work, only executed when nothing else is queued (unless weights are set).
+    };
+
+    static constexpr size_t PriorityCount = 3;
+
+    enum class ReturnCode
+    {
+        NORMAL,             /*!< No error, the function is queued */
+        QUEUE_FULL,         /*!< The queue is full and the function was rejected (OverflowPolicy::Reject) */
+        DROPPED,            /*!< The queue is full and the function was dropped (OverflowPolicy::DropNewest, or
+                                 DropOldest when no queued function could be taken out) */
+        INVALID_ARG         /*!< The function is empty, nothing is queued */
+    };
+
+    /*! @brief What executeFunction() does when a bounded queue is full */
+    enum class OverflowPolicy
+    {
+        Block,      // Wait until the AO thread has taken a function. Never waits when called from the AO thread itself.
+        Reject,     // Return ReturnCode::QUEUE_FULL.
+        DropOldest, // Queue the function and drop the oldest one of the lowest non-empty priority level. If the other
+                    // producers are all still pushing theirs, drop this one and return ReturnCode::DROPPED instead.
+        DropNewest  // Drop the function and return ReturnCode::DROPPED.
+    };
+
+    /*! @brief Called with the queue depth when it reaches highWatermark, then when it falls back to lowWatermark. The
+    * high one is called by the thread calling executeFunction(), the low one by the AO thread, so possibly at the same
+    * time. */
+    using WatermarkFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(size_t depth)>;
+
+    struct QueueOptions
+    {
+        size_t capacity = 0;            /*!< Max functions queued over all priority levels, 0 means unbounded */
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+        size_t highWatermark = 0;       /*!< 0 disables watermark callbacks, also usable with an unbounded queue */
+        size_t lowWatermark = 0;
+        WatermarkFunc onHighWatermark;
+        WatermarkFunc onLowWatermark;
+    };
+
+    struct QueueStatistics
+    {
+        size_t depth = 0;               /*!< Functions queued, over all priority levels */
+        size_t maxDepth = 0;            /*!< Highest depth reached */
+        uint64_t rejectedFunctions = 0; /*!< Functions rejected with ReturnCode::QUEUE_FULL */
+        uint64_t droppedFunctions = 0;  /*!< Functions dropped by OverflowPolicy::DropOldest or DropNewest */
+        uint64_t blockedCalls = 0;      /*!< executeFunction() calls which had to wait with OverflowPolicy::Block */
+    };
+
     /*! @brief Creates a new Active Object for current calling thread.
     *   @param[in] initFunc A optional initialization function which is done before any other things are handled.
     * For example, you can simply can IActiveObject::create() or utilize lamda expressions to pass initFunc to AO.
@@ -75,14 +137,70 @@ public:
     * shared pointer will be nullptr. You need to double check the return pointer before using. Once use_count
     * of shared pointer becomes zero, the AO thread will automatically terminated after all scheduled functions
     * in the event queue have been carried out. */
-    static std::shared_ptr<IActiveObject> create(const std::function<void()>& initFunc = nullptr, \
+    static std::shared_ptr<IActiveObject> create(AOFunc&& initFunc = nullptr, \
+                                            const SchedulingPolicy& schedPolicy = SchedulingPolicy::Default);
+
+    static std::shared_ptr<IActiveObject> create(const std::string& name, \
+                                            AOFunc&& initFunc = nullptr, \
                                             const SchedulingPolicy& schedPolicy = SchedulingPolicy::Default);
 
+    /*! @brief Same as above, with a bounded event queue, see QueueOptions. */
     static std::shared_ptr<IActiveObject> create(const std::string& name, \
-                                            const std::function<void()>& initFunc = nullptr, \
+                                            QueueOptions&& queueOptions, \
+                                            AOFunc&& initFunc = nullptr, \
                                             const SchedulingPolicy& schedPolicy = SchedulingPolicy::Default);
 
-    virtual void executeFunction(const std::function<void()>& func = nullptr);
+    /*! @brief Executes asynchronously func in the context of the AO thread.
+    *   @param[in] func Function to be executed.
+    *   @param[in] priority Queue the function is put in, Priority::Normal by default.
+    *   @return NORMAL, INVALID_ARG if func is empty, or what the overflow policy returns when a bounded queue is
+    *   full. */
+    virtual ReturnCode executeFunction(AOFunc&& func = nullptr, Priority priority = Priority::Normal) = 0;
+
+    /*! @brief Same as executeFunction(), for a function returning a result: returns a Future of that result, which
+    * then() can hand over to another AO or Event Loop without blocking any thread, see Future. If a bounded queue
+    * rejects or drops the function, the returned Future is already broken (Future::isBroken()), and is broken later
+    * if DropOldest drops the function from the queue. Its continuations are then dropped.
+    * Usage:
+    *
+    * </code>
+    *   ao->submit([request]() { return computeReply(request); })
+    *       .then(IEventLoop::getThreadLocalInstance(), [](Reply reply) { send(reply); });
+    * </code>
+    */
+    template <typename F>
+    auto submit(F&& func, Priority priority = Priority::Normal) -> Future<std::invoke_result_t<std::decay_t<F>&>>
+    {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+
+        Promise<R> promise;
+        Future<R> future = promise.getFuture();
+        AOFunc task([promise = std::move(promise), func = std::forward<F>(func)]() mutable
+        {
+            Detail::fulfill(promise, func);
+        });
+        if(executeFunction(std::move(task), priority) != ReturnCode::NORMAL)
+        {
+            /* Destroying the refused function destroys the Promise, which breaks the Future before it is returned */
+            task = nullptr;
+        }
+
+        return future;
+    }
+
+    /*! @brief Selects how the AO thread services the priority levels. With all weights 0 (default), servicing is strict:
+    * a function is only taken from a level when every higher level is empty, so Background work may starve while
+    * Urgent/Normal functions keep coming. Otherwise the levels are visited in turn, from Urgent to Background, and up to
+    * weight functions are executed from each one per turn (a weight of 0 then counts as 1).
+    * Can be called from any thread. */
+    virtual void setPriorityWeights(uint32_t urgentWeight, uint32_t normalWeight, uint32_t backgroundWeight) = 0;
+
+    /*! @brief Returns the number of functions queued at priority and not executed yet. Can be called from any thread,
+    * the value is only a snapshot. */
+    virtual size_t getQueueDepth(Priority priority) const = 0;
+
+    /*! @brief Depth, high-water mark and overflow counters of the whole queue. Can be called from any thread. */
+    virtual QueueStatistics getQueueStatistics() const = 0;
 
     // To avoid user doing copy/move operations
     IActiveObject(const IActiveObject&) = delete;
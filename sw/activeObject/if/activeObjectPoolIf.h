@@ -0,0 +1,102 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "activeObjectIf.h"
+#include "inplaceFunctionIf.h"
+
+namespace UtilsFramework
+{
+namespace ActiveObject
+{
+namespace V1
+{
+/*! @brief Active Object Pool: N worker threads sharing the functions given to the pool, for CPU-bound fan-out which
+* would otherwise need dozens of Active Objects and round-robin by hand.
+* Each worker has its own work-stealing deque. A function given from one of the workers goes to the deque of that
+* worker, a function given from any other thread goes to the workers in turn, and a worker which has nothing left
+* steals the oldest functions of the others. Like an AO thread, each worker runs its own thread-local Event Loop, so
+* functions can use ITimerManager, IItcPubSub,... through IEventLoop::getThreadLocalInstance().
+*
+* Example usage:
+*
+* </code>
+*   auto pool = IActiveObjectPool::create(4);
+*   for(auto& chunk : chunks)
+*   {
+*       pool->executeFunction([&chunk]() { process(chunk); });
+*   }
+* </code>
+*
+* Functions are not executed in the order they are given, and may run on any worker. Once use_count of the shared
+* pointer becomes zero, every function already given is carried out, then the workers are stopped and joined.
+* While stopping, functions given by the workers themselves (e.g. by a function fanning out) are still accepted and
+* carried out before the workers end, functions given by any other thread are refused with ReturnCode::STOPPED. */
+class IActiveObjectPool
+{
+public:
+    using AOFunc = IActiveObject::AOFunc;
+
+    /*! @brief Called once by every worker, with its index, before it executes any function. It is called by all
+    * workers at the same time, so it must only touch thread-local or synchronized data. */
+    using WorkerInitFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(uint32_t workerIndex)>;
+
+    enum class ReturnCode
+    {
+        NORMAL,     /*!< No error, the function will be executed */
+        STOPPED,    /*!< The pool is stopping and the function was given by a thread other than its workers, it is
+                         destroyed without being executed */
+        INVALID_ARG /*!< The function is empty, nothing is queued */
+    };
+
+    struct Statistics
+    {
+        uint64_t executedFunctions = 0;     /*!< Functions executed by all workers */
+        uint64_t stolenFunctions = 0;       /*!< Functions a worker took from the deque of another worker */
+    };
+
+    /*! @brief Starts numWorkers worker threads, named <name>-<index>, and returns once all of them are running.
+    *   @param[in] numWorkers Number of workers, 0 means one per online CPU.
+    *   @return nullptr if a worker could not be started. */
+    static std::shared_ptr<IActiveObjectPool> create(uint32_t numWorkers, \
+                                            WorkerInitFunc&& initFunc = nullptr, \
+                                            const std::string& name = "ActiveObjectPool", \
+                                            const IActiveObject::SchedulingPolicy& schedPolicy = IActiveObject::SchedulingPolicy::Default);
+
+    /*! @brief Executes asynchronously func on one of the workers. Can be called from any thread.
+    *   @return NORMAL, INVALID_ARG if func is empty, or STOPPED, see ReturnCode. */
+    virtual ReturnCode executeFunction(AOFunc&& func = nullptr) = 0;
+
+    virtual uint32_t getNumWorkers() const = 0;
+
+    virtual Statistics getStatistics() const = 0;
+
+    // To avoid user doing copy/move operations
+    IActiveObjectPool(const IActiveObjectPool&) = delete;
+    IActiveObjectPool(IActiveObjectPool&&) = delete;
+    IActiveObjectPool& operator=(const IActiveObjectPool&) = delete;
+    IActiveObjectPool& operator=(IActiveObjectPool&&) = delete;
+
+protected:
+    // Only backend implementation (behind the scene) can define constructor and destructor.
+    IActiveObjectPool() = default;
+    ~IActiveObjectPool() = default;
+
+}; // class IActiveObjectPool
+
+} // namespace V1
+
+} // namespace ActiveObject
+
+} // namespace UtilsFramework
@@ -0,0 +1,517 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "inplaceFunctionIf.h"
+
+namespace UtilsFramework
+{
+namespace ActiveObject
+{
+namespace V1
+{
+/*! @brief Promise/Future pair for handing a result from one thread to another without blocking any of them.
+* IActiveObject::submit() returns a Future of the result of the function, and then() chains a continuation which is
+* called with that result once it is available:
+* + then(func) runs func on the thread which sets the result, or right away if it is already set.
+* + then(executor, func) runs func on executor: an IActiveObject, an IActiveObjectPool or an IEventLoop (through
+*   post()). The executor must outlive the Future.
+*
+* Example usage:
+*
+* </code>
+*   parserAo->submit([request]() { return parse(request); })
+*       .then(*dbAo, [](Query query) { return lookup(query); })
+*       .then(IEventLoop::getThreadLocalInstance(), [client](Reply reply) { client->send(reply); });
+* </code>
+*
+* The state shared by a Promise and its Future is allocated from a thread-local free list, so a steady flow of
+* requests does not go through the heap. A Future has at most one continuation, then() consumes it. If the Promise is
+* destroyed without a value, the Future is broken (isBroken()) and the continuations of the chain are destroyed without
+* being called, each Future of the chain becoming broken in turn. This happens when the function or a continuation is
+* refused by its executor (full bounded queue, pool stopping,...) or destroyed unrun by it. Functions and
+* continuations must not throw, and must fit in an InplaceFunction along with a pointer. */
+template <typename R>
+class Future;
+
+template <typename R>
+class Promise;
+
+namespace Detail
+{
+
+struct VoidValue
+{
+};
+
+/* Free list of shared states of one size, one per thread. States released by another thread than the allocating one
+*  join the list of the releasing thread, MaxFreeStates bounds each list. */
+template <size_t Size>
+class SharedStatePool
+{
+public:
+    static constexpr uint32_t MaxFreeStates = 256;
+
+    static SharedStatePool& getThreadLocalInstance()
+    {
+        static thread_local SharedStatePool pool;
+        return pool;
+    }
+
+    void* allocate()
+    {
+        if(m_freeStates == nullptr)
+        {
+            return ::operator new(Size);
+        }
+
+        FreeState* state = m_freeStates;
+        m_freeStates = state->next;
+        --m_freeStateCount;
+        return state;
+    }
+
+    void deallocate(void* ptr) noexcept
+    {
+        if(m_freeStateCount >= MaxFreeStates)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        FreeState* state = static_cast<FreeState*>(ptr);
+        state->next = m_freeStates;
+        m_freeStates = state;
+        ++m_freeStateCount;
+    }
+
+    ~SharedStatePool()
+    {
+        while(m_freeStates != nullptr)
+        {
+            FreeState* next = m_freeStates->next;
+            ::operator delete(m_freeStates);
+            m_freeStates = next;
+        }
+    }
+
+    // First prevent copy/move construtors
+    SharedStatePool(const SharedStatePool&)               = delete;
+    SharedStatePool(SharedStatePool&&)                    = delete;
+    SharedStatePool& operator=(const SharedStatePool&)    = delete;
+    SharedStatePool& operator=(SharedStatePool&&)         = delete;
+
+private:
+    SharedStatePool() = default;
+
+    struct FreeState
+    {
+        FreeState* next;
+    };
+
+    static_assert(Size >= sizeof(FreeState), "SharedStatePool - Size is too small!");
+
+    FreeState* m_freeStates = nullptr;
+    uint32_t m_freeStateCount = 0;
+};
+
+/* State shared by a Promise, its Future and the continuation set through the Future. The Promise and the Future each
+*  hold a reference. Whoever of the Promise (setting the value or abandoning) and the Future (setting the continuation)
+*  comes second handles the continuation, the status bits tell which one came first. */
+template <typename R>
+class SharedState
+{
+public:
+    using Value = std::conditional_t<std::is_void<R>::value, VoidValue, R>;
+    using Continuation = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(SharedState&)>;
+
+    /* Posts a task running the continuation to executor */
+    using DispatchFunc = void (*)(void* executor, SharedState* state);
+
+    static void* operator new(size_t size)
+    {
+        (void)size;
+        return SharedStatePool<sizeof(SharedState)>::getThreadLocalInstance().allocate();
+    }
+
+    static void operator delete(void* ptr) noexcept
+    {
+        SharedStatePool<sizeof(SharedState)>::getThreadLocalInstance().deallocate(ptr);
+    }
+
+    void addRef()
+    {
+        m_refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release()
+    {
+        if(m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete this;
+        }
+    }
+
+    template <typename... Args>
+    void setValue(Args&&... args)
+    {
+        m_value.emplace(std::forward<Args>(args)...);
+        publish(ValueSet);
+    }
+
+    void abandon()
+    {
+        publish(Abandoned);
+    }
+
+    bool isReady() const
+    {
+        return (m_status.load(std::memory_order_acquire) & ValueSet) != 0;
+    }
+
+    bool isAbandoned() const
+    {
+        return (m_status.load(std::memory_order_acquire) & Abandoned) != 0;
+    }
+
+    Value takeValue()
+    {
+        return std::move(*m_value);
+    }
+
+    /* Takes over the reference of the Future, which is released once the continuation has run or been dropped */
+    void setContinuation(Continuation&& continuation, void* executor, DispatchFunc dispatch)
+    {
+        m_continuation = std::move(continuation);
+        m_executor = executor;
+        m_dispatch = dispatch;
+
+        uint32_t previous = m_status.fetch_or(ContinuationSet, std::memory_order_acq_rel);
+        if(previous & ValueSet)
+        {
+            dispatchContinuation();
+        } else if(previous & Abandoned)
+        {
+            dropContinuation();
+        }
+    }
+
+    void runContinuation()
+    {
+        m_continuation(*this);
+        m_continuation = nullptr;
+        release();
+    }
+
+    void dropContinuation()
+    {
+        m_continuation = nullptr;
+        release();
+    }
+
+private:
+    enum : uint32_t
+    {
+        ValueSet        = 1 << 0,
+        Abandoned       = 1 << 1,
+        ContinuationSet = 1 << 2
+    };
+
+    void publish(uint32_t status)
+    {
+        uint32_t previous = m_status.fetch_or(status, std::memory_order_acq_rel);
+        if(previous & ContinuationSet)
+        {
+            if(status == ValueSet)
+            {
+                dispatchContinuation();
+            } else
+            {
+                dropContinuation();
+            }
+        }
+    }
+
+    void dispatchContinuation()
+    {
+        if(m_dispatch != nullptr)
+        {
+            m_dispatch(m_executor, this);
+        } else
+        {
+            runContinuation();
+        }
+    }
+
+    std::atomic<uint32_t> m_refCount{1};
+    std::atomic<uint32_t> m_status{0};
+    std::optional<Value> m_value;
+    Continuation m_continuation;
+    void* m_executor = nullptr;
+    DispatchFunc m_dispatch = nullptr;
+};
+
+/* Task posted to the executor of a continuation. Drops the continuation if the executor destroys it without running
+*  it, so that the chain is not leaked. */
+template <typename R>
+class ContinuationTask
+{
+public:
+    explicit ContinuationTask(SharedState<R>* state) : m_state(state) {}
+    ContinuationTask(ContinuationTask&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+    ContinuationTask(const ContinuationTask&) = delete;
+    ContinuationTask& operator=(const ContinuationTask&) = delete;
+    ContinuationTask& operator=(ContinuationTask&&) = delete;
+
+    ~ContinuationTask()
+    {
+        if(m_state != nullptr)
+        {
+            m_state->dropContinuation();
+        }
+    }
+
+    void operator()()
+    {
+        std::exchange(m_state, nullptr)->runContinuation();
+    }
+
+private:
+    SharedState<R>* m_state;
+};
+
+/* IActiveObject and IActiveObjectPool have executeFunction(), IEventLoop has post(). A task refused by the executor
+*  is destroyed right away, so that a Promise it holds breaks its Future. */
+using Task = UtilsFramework::InplaceFunction::V1::InplaceFunction<void()>;
+
+template <typename Executor>
+auto execute(Executor& executor, Task&& task, int) -> decltype(executor.executeFunction(std::move(task)), bool())
+{
+    if(executor.executeFunction(std::move(task)) != Executor::ReturnCode::NORMAL)
+    {
+        task = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+template <typename Executor>
+auto execute(Executor& executor, Task&& task, long) -> decltype((void)executor.post(std::move(task)), bool())
+{
+    if(executor.post(std::move(task)) != Executor::ReturnCode::NORMAL)
+    {
+        task = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+template <typename R, typename F>
+struct ContinuationResult
+{
+    using type = std::invoke_result_t<F&, R&&>;
+};
+
+template <typename F>
+struct ContinuationResult<void, F>
+{
+    using type = std::invoke_result_t<F&>;
+};
+
+/* Calls func with args and sets its result to promise */
+template <typename T, typename F, typename... Args>
+void fulfill(Promise<T>& promise, F& func, Args&&... args)
+{
+    if constexpr(std::is_void<T>::value)
+    {
+        func(std::forward<Args>(args)...);
+        promise.setValue();
+    } else
+    {
+        promise.setValue(func(std::forward<Args>(args)...));
+    }
+}
+
+} // namespace Detail
+
+template <typename R>
+class Promise
+{
+public:
+    Promise() : m_state(new Detail::SharedState<R>()) {}
+
+    Promise(Promise&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)), m_isSet(other.m_isSet) {}
+
+    ~Promise()
+    {
+        if(m_state != nullptr)
+        {
+            if(!m_isSet)
+            {
+                m_state->abandon();
+            }
+            m_state->release();
+        }
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+    Promise& operator=(Promise&&) = delete;
+
+    /*! @brief Must be called at most once */
+    Future<R> getFuture()
+    {
+        m_state->addRef();
+        return Future<R>(m_state);
+    }
+
+    /*! @brief Must be called at most once. Continuations set with then(func) run from here. */
+    template <typename... Args>
+    void setValue(Args&&... args)
+    {
+        m_isSet = true;
+        m_state->setValue(std::forward<Args>(args)...);
+    }
+
+private:
+    Detail::SharedState<R>* m_state;
+    bool m_isSet = false;
+};
+
+template <typename R>
+class Future
+{
+public:
+    Future() = default;
+    Future(Future&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+
+    Future& operator=(Future&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            m_state = std::exchange(other.m_state, nullptr);
+        }
+        return *this;
+    }
+
+    ~Future()
+    {
+        reset();
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    /*! @brief False once then() or tryGet() consumed the Future */
+    bool isValid() const
+    {
+        return m_state != nullptr;
+    }
+
+    bool isReady() const
+    {
+        return m_state != nullptr && m_state->isReady();
+    }
+
+    /*! @brief True if the value will never be set: the Promise was destroyed without it, see the class description */
+    bool isBroken() const
+    {
+        return m_state != nullptr && !m_state->isReady() && m_state->isAbandoned();
+    }
+
+    /*! @brief Moves the value out if it is set, the Future is then consumed. Never blocks. */
+    template <typename T = R, typename = std::enable_if_t<!std::is_void<T>::value>>
+    bool tryGet(T& value)
+    {
+        if(!isReady())
+        {
+            return false;
+        }
+
+        value = m_state->takeValue();
+        reset();
+        return true;
+    }
+
+    /*! @brief Calls func with the value on the thread which sets it, or right away if it is already set */
+    template <typename F>
+    auto then(F&& func) -> Future<typename Detail::ContinuationResult<R, std::decay_t<F>>::type>
+    {
+        return chain(nullptr, nullptr, std::forward<F>(func));
+    }
+
+    /*! @brief Calls func with the value on executor, see the class description. If executor refuses the
+    * continuation, it is dropped and the returned Future is broken. */
+    template <typename Executor, typename F>
+    auto then(Executor& executor, F&& func) -> Future<typename Detail::ContinuationResult<R, std::decay_t<F>>::type>
+    {
+        return chain(&executor, [](void* executorPtr, Detail::SharedState<R>* state)
+        {
+            (void)Detail::execute(*static_cast<Executor*>(executorPtr), Detail::ContinuationTask<R>(state), 0);
+        }, std::forward<F>(func));
+    }
+
+private:
+    template <typename T>
+    friend class Promise;
+
+    explicit Future(Detail::SharedState<R>* state) : m_state(state) {}
+
+    void reset()
+    {
+        if(m_state != nullptr)
+        {
+            std::exchange(m_state, nullptr)->release();
+        }
+    }
+
+    template <typename F>
+    auto chain(void* executor, typename Detail::SharedState<R>::DispatchFunc dispatch, F&& func)
+        -> Future<typename Detail::ContinuationResult<R, std::decay_t<F>>::type>
+    {
+        using Next = typename Detail::ContinuationResult<R, std::decay_t<F>>::type;
+
+        Promise<Next> promise;
+        Future<Next> future = promise.getFuture();
+        std::exchange(m_state, nullptr)->setContinuation([promise = std::move(promise), func = std::forward<F>(func)]
+            (Detail::SharedState<R>& state) mutable
+        {
+            if constexpr(std::is_void<R>::value)
+            {
+                (void)state;
+                Detail::fulfill(promise, func);
+            } else
+            {
+                Detail::fulfill(promise, func, state.takeValue());
+            }
+        }, executor, dispatch);
+
+        return future;
+    }
+
+    Detail::SharedState<R>* m_state = nullptr;
+};
+
+} // namespace V1
+
+} // namespace ActiveObject
+
+} // namespace UtilsFramework
@@ -35,9 +35,13 @@ public:
     ActiveObjectImpl& operator=(const ActiveObjectImpl&)    = delete;
     ActiveObjectImpl& operator=(ActiveObjectImpl&&)         = delete;
 
-    bool createThread(const std::string& name, const SchedulingPolicy& schedPolicy, const std::function<void()>& initFunc);
+    bool createThread(const std::string& name, const SchedulingPolicy& schedPolicy, AOFunc&& initFunc, \
+                    QueueOptions&& queueOptions);
 
-    void executeFunction(const std::function<void()>& func) override;
+    ReturnCode executeFunction(AOFunc&& func, Priority priority) override;
+    void setPriorityWeights(uint32_t urgentWeight, uint32_t normalWeight, uint32_t backgroundWeight) override;
+    size_t getQueueDepth(Priority priority) const override;
+    QueueStatistics getQueueStatistics() const override;
 
 private:
     std::shared_ptr<ActiveObjectThread> m_aoThread;
@@ -0,0 +1,52 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <memory>
+
+#include "activeObjectPoolIf.h"
+#include "workStealingScheduler.h"
+
+namespace UtilsFramework
+{
+namespace ActiveObject
+{
+namespace V1
+{
+using namespace UtilsFramework::ActiveObject::implementation;
+
+class ActiveObjectPoolImpl : public IActiveObjectPool
+{
+public:
+    ActiveObjectPoolImpl() = default;
+    ~ActiveObjectPoolImpl();
+
+    // First avoid copy/move constructors
+    ActiveObjectPoolImpl(const ActiveObjectPoolImpl&)               = delete;
+    ActiveObjectPoolImpl(ActiveObjectPoolImpl&&)                    = delete;
+    ActiveObjectPoolImpl& operator=(const ActiveObjectPoolImpl&)    = delete;
+    ActiveObjectPoolImpl& operator=(ActiveObjectPoolImpl&&)         = delete;
+
+    bool createWorkers(uint32_t numWorkers, const std::string& name, \
+                    const IActiveObject::SchedulingPolicy& schedPolicy, WorkerInitFunc&& initFunc);
+
+    ReturnCode executeFunction(AOFunc&& func) override;
+    uint32_t getNumWorkers() const override;
+    Statistics getStatistics() const override;
+
+private:
+    std::shared_ptr<WorkStealingScheduler> m_scheduler;
+};
+
+} // namespace V1
+
+} // namespace ActiveObject
+
+} // namespace UtilsFramework
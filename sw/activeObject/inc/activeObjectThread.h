@@ -9,13 +9,16 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
-#include <functional>
-#include <vector>
 
+#include "activeObjectIf.h"
 #include "eventLoopIf.h"
+#include "mpscQueue.h"
 
 namespace UtilsFramework::ActiveObject::implementation
 {
@@ -26,7 +29,11 @@ class ActiveObjectThread
 {
 public:
     // By using explicit modifier, only this type of constructor is accepted
-    explicit ActiveObjectThread(const std::string& name);
+    using QueueOptions = UtilsFramework::ActiveObject::V1::IActiveObject::QueueOptions;
+    using QueueStatistics = UtilsFramework::ActiveObject::V1::IActiveObject::QueueStatistics;
+    using ReturnCode = UtilsFramework::ActiveObject::V1::IActiveObject::ReturnCode;
+
+    ActiveObjectThread(const std::string& name, QueueOptions&& queueOptions);
     ~ActiveObjectThread();
 
     // First avoid copy/move constructors
@@ -35,26 +42,78 @@ public:
     ActiveObjectThread& operator=(const ActiveObjectThread&)    = delete;
     ActiveObjectThread& operator=(ActiveObjectThread&&)         = delete;
 
-    using AOFunc = std::function<void()>;
+    using AOFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void()>;
+
+    /* Priority levels, 0 being the highest, see IActiveObject::Priority */
+    static constexpr uint32_t PriorityCount = 3;
+    static constexpr uint32_t DefaultPriority = 1;
 
-    bool start(bool isFifo, const AOFunc& initFunc);
-    void scheduleFunction(const AOFunc& func);
+    bool start(bool isFifo, AOFunc&& initFunc);
+    ReturnCode scheduleFunction(AOFunc&& func, uint32_t priority = DefaultPriority);
+    void setWeights(const std::array<uint32_t, PriorityCount>& weights);
+    size_t getQueueDepth(uint32_t priority) const;
+    QueueStatistics getQueueStatistics() const;
 
 private:
     static void mainFunction(const std::string& name, int eventFd, \
-                    const IEventLoop::CallbackFunc& fdHandler, \
-                    bool isFifo, const AOFunc& initFunc);
+                    IEventLoop::CallbackFunc&& fdHandler, \
+                    bool isFifo, AOFunc&& initFunc);
 
     static void stopEventLoop(int eventFd);
-    void enqueueFunction(const AOFunc& func);
-    AOFunc dequeueFunction();
+    void notify();
     void handleFdEvent();
+    bool popFunction(AOFunc& func);
+    bool isQueueEmpty();
+    void pushFunction(AOFunc&& func, uint32_t priority);
+    bool tryReserve(size_t& depth);
+    void onDepthIncreased(size_t depth);
+    void onFunctionTaken();
+    bool takeFunction(uint32_t priority, AOFunc& func);
+    bool dropOldestFunction();
+
+    /* Functions are executed in batches, bounded so that the other FDs of the AO Event Loop (timers,...) still get
+    *  dispatched while producers keep the queue busy */
+    static constexpr uint32_t MaxFunctionsPerWakeup = 1024;
 
     std::string m_name;
     std::thread m_thread;
     int m_eventFd;
-    std::mutex m_mutex;
-    std::vector<AOFunc> m_funcQueue;
+
+    /* Lock-free task queues, one per priority level. m_eventFd is only written by the producer which sets
+    *  m_isWakeupPending, i.e. once per batch: while the AO Thread is executing functions the flag stays set and
+    *  producers make no system call. */
+    std::array<UtilsFramework::Common::V1::MpscQueue<AOFunc>, PriorityCount> m_funcQueues;
+    std::array<std::atomic<size_t>, PriorityCount> m_queueDepths;
+    std::atomic<bool> m_isWakeupPending;
+
+    /* Weighted servicing, all weights 0 means strict. m_level and m_credit are only used by the AO Thread */
+    std::array<std::atomic<uint32_t>, PriorityCount> m_weights;
+    std::atomic<bool> m_isWeighted;
+    uint32_t m_level;
+    uint32_t m_credit;
+
+    /* Bounded queue. m_depth counts the functions queued over all levels */
+    QueueOptions m_queueOptions;
+    std::atomic<size_t> m_depth;
+    std::atomic<size_t> m_maxDepth;
+
+    /* With OverflowPolicy::DropOldest, a producer finding the queue full takes the oldest function out itself. The
+    *  queues then have more than one consumer, so every pop and empty check, by the AO Thread too, is done under
+    *  m_dropMutex. The other policies keep the queues lock-free. */
+    const bool m_isDropOldest;
+    std::mutex m_dropMutex;
+    std::atomic<bool> m_isAboveHighWatermark;
+    std::atomic<uint64_t> m_rejectedFunctions;
+    std::atomic<uint64_t> m_droppedFunctions;
+    std::atomic<uint64_t> m_blockedCalls;
+
+    /* Producers waiting with OverflowPolicy::Block, only notified by the AO Thread while m_blockedProducers > 0 */
+    std::atomic<uint32_t> m_blockedProducers;
+    std::mutex m_blockMutex;
+    std::condition_variable m_notFull;
+
+    /* Set by the destructor, the AO Thread stops its Event Loop once all queues are empty */
+    std::atomic<bool> m_isStopRequested;
 };
 
 } // namespace UtilsFramework::ActiveObject::implementation
\ No newline at end of file
@@ -0,0 +1,107 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "activeObjectPoolIf.h"
+#include "chaseLevDeque.h"
+#include "eventLoopIf.h"
+#include "mpscQueue.h"
+
+namespace UtilsFramework::ActiveObject::implementation
+{
+
+using namespace UtilsFramework::EventLoop::V1;
+
+/* Worker threads of an Active Object Pool. Worker threads keep it alive until they end, so that the pool can also be
+*  released from one of its own functions. */
+class WorkStealingScheduler : public std::enable_shared_from_this<WorkStealingScheduler>
+{
+public:
+    using AOFunc = UtilsFramework::ActiveObject::V1::IActiveObjectPool::AOFunc;
+    using WorkerInitFunc = UtilsFramework::ActiveObject::V1::IActiveObjectPool::WorkerInitFunc;
+    using ReturnCode = UtilsFramework::ActiveObject::V1::IActiveObjectPool::ReturnCode;
+
+    // By using explicit modifier, only this type of constructor is accepted
+    explicit WorkStealingScheduler(const std::string& name);
+    ~WorkStealingScheduler();
+
+    // First avoid copy/move constructors
+    WorkStealingScheduler(const WorkStealingScheduler&)               = delete;
+    WorkStealingScheduler(WorkStealingScheduler&&)                    = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&)    = delete;
+    WorkStealingScheduler& operator=(WorkStealingScheduler&&)         = delete;
+
+    bool start(uint32_t numWorkers, bool isFifo, WorkerInitFunc&& initFunc);
+
+    /* Lets the workers end once every function has been executed, and joins them */
+    void stop();
+
+    /* Returns INVALID_ARG if func is empty, STOPPED, and destroys func, if stop() was called and func is not given by
+    *  one of the workers */
+    ReturnCode scheduleFunction(AOFunc&& func);
+    uint32_t getNumWorkers() const;
+    void getStatistics(uint64_t& executedFunctions, uint64_t& stolenFunctions) const;
+
+private:
+    struct Worker
+    {
+        /* Functions given by this worker, stolen by the others from the top */
+        UtilsFramework::Common::V1::ChaseLevDeque<AOFunc*> deque;
+
+        /* Functions given by other threads, moved to the deque by this worker */
+        UtilsFramework::Common::V1::MpscQueue<AOFunc*> inbox;
+
+        /* Same protocol as ActiveObjectThread: cleared by the worker when it goes idle, whoever sets it again writes
+        *  eventFd. m_idleWorkers counts the workers with the flag cleared. */
+        std::atomic<bool> isWakeupPending{false};
+
+        std::atomic<uint64_t> executedFunctions{0};
+        std::atomic<uint64_t> stolenFunctions{0};
+
+        int eventFd = -1;
+        uint32_t index = 0;
+        std::thread thread;
+        std::thread::id threadId;
+    };
+
+    static void workerMain(std::shared_ptr<WorkStealingScheduler> self, Worker& worker, bool isFifo, \
+                    std::promise<bool> started);
+
+    void handleFdEvent(Worker& worker);
+    bool takeFunction(Worker& worker, AOFunc*& func);
+    bool hasFunctions(Worker& worker) const;
+    bool claimWakeup(Worker& worker);
+    void wakeIdleWorker(uint32_t fromIndex);
+    static void notify(const Worker& worker);
+
+    /* Same bound as ActiveObjectThread, so that the other FDs of a worker Event Loop are still dispatched */
+    static constexpr uint32_t MaxFunctionsPerWakeup = 1024;
+
+    std::string m_name;
+    uint32_t m_numWorkers;
+    std::unique_ptr<Worker[]> m_workers;
+    WorkerInitFunc m_initFunc;
+
+    std::atomic<uint32_t> m_nextWorker;
+    std::atomic<uint32_t> m_idleWorkers;
+    std::atomic<bool> m_isStopping;
+
+    /* Other threads inside scheduleFunction() having passed the m_isStopping check. Workers do not stop before it
+    *  drops to zero, so that the function being given is not stranded in the inbox of a stopped worker. */
+    std::atomic<uint32_t> m_activeSubmitters;
+};
+
+} // namespace UtilsFramework::ActiveObject::implementation
@@ -1,4 +1,4 @@
-#include <functional>
+#include <utility>
 #include "activeObjectImpl.h"
 
 using namespace UtilsFramework::ActiveObject::implementation;
@@ -12,15 +12,21 @@ namespace ActiveObject
 namespace V1
 {
 
-std::shared_ptr<IActiveObject> IActiveObject::create(const std::function<void()>& initFunc, const SchedulingPolicy& schedPolicy)
+std::shared_ptr<IActiveObject> IActiveObject::create(AOFunc&& initFunc, const SchedulingPolicy& schedPolicy)
 {
-	return create("ActiveObjectThread", initFunc, schedPolicy);
+	return create("ActiveObjectThread", std::move(initFunc), schedPolicy);
 }
 
-std::shared_ptr<IActiveObject> IActiveObject::create(const std::string& name, const std::function<void()>& initFunc, const SchedulingPolicy& schedPolicy)
+std::shared_ptr<IActiveObject> IActiveObject::create(const std::string& name, AOFunc&& initFunc, const SchedulingPolicy& schedPolicy)
+{
+	return create(name, QueueOptions(), std::move(initFunc), schedPolicy);
+}
+
+std::shared_ptr<IActiveObject> IActiveObject::create(const std::string& name, QueueOptions&& queueOptions, AOFunc&& initFunc, \
+                                        const SchedulingPolicy& schedPolicy)
 {
 	auto ao = std::make_shared<ActiveObjectImpl>();
-	if(!ao->createThread(name, schedPolicy, initFunc))
+	if(!ao->createThread(name, schedPolicy, std::move(initFunc), std::move(queueOptions)))
 	{
 		ao.reset(); // Reset shared_ptr to nullptr
 	}
@@ -28,18 +34,34 @@ std::shared_ptr<IActiveObject> IActiveObject::create(const std::string& name, co
 	return ao;
 }
 
-bool ActiveObjectImpl::createThread(const std::string& name, const SchedulingPolicy& schedPolicy, const std::function<void()>& initFunc)
+bool ActiveObjectImpl::createThread(const std::string& name, const SchedulingPolicy& schedPolicy, AOFunc&& initFunc, \
+                                    QueueOptions&& queueOptions)
 {
 	bool isFifo = (schedPolicy == SchedulingPolicy::Fifo);
 
-	m_aoThread = std::make_shared<ActiveObjectThread>(name);
+	m_aoThread = std::make_shared<ActiveObjectThread>(name, std::move(queueOptions));
+
+	return m_aoThread->start(isFifo, std::move(initFunc));
+}
+
+IActiveObject::ReturnCode ActiveObjectImpl::executeFunction(AOFunc&& func, Priority priority)
+{
+	return m_aoThread->scheduleFunction(std::move(func), static_cast<uint32_t>(priority));
+}
+
+void ActiveObjectImpl::setPriorityWeights(uint32_t urgentWeight, uint32_t normalWeight, uint32_t backgroundWeight)
+{
+	m_aoThread->setWeights({urgentWeight, normalWeight, backgroundWeight});
+}
 
-	return m_aoThread->start(isFifo, initFunc);
+size_t ActiveObjectImpl::getQueueDepth(Priority priority) const
+{
+	return m_aoThread->getQueueDepth(static_cast<uint32_t>(priority));
 }
 
-void ActiveObjectImpl::executeFunction(const std::function<void()>& func)
+IActiveObject::QueueStatistics ActiveObjectImpl::getQueueStatistics() const
 {
-	m_aoThread->scheduleFunction(func);
+	return m_aoThread->getQueueStatistics();
 }
 
 } // namespace V1
@@ -0,0 +1,77 @@
+#include <thread>
+#include <utility>
+
+#include "activeObjectPoolImpl.h"
+
+using namespace UtilsFramework::ActiveObject::implementation;
+
+namespace UtilsFramework
+{
+
+namespace ActiveObject
+{
+
+namespace V1
+{
+
+std::shared_ptr<IActiveObjectPool> IActiveObjectPool::create(uint32_t numWorkers, WorkerInitFunc&& initFunc, \
+                                        const std::string& name, const IActiveObject::SchedulingPolicy& schedPolicy)
+{
+	auto pool = std::make_shared<ActiveObjectPoolImpl>();
+	if(!pool->createWorkers(numWorkers, name, schedPolicy, std::move(initFunc)))
+	{
+		pool.reset(); // Reset shared_ptr to nullptr
+	}
+
+	return pool;
+}
+
+ActiveObjectPoolImpl::~ActiveObjectPoolImpl()
+{
+	if(m_scheduler)
+	{
+		m_scheduler->stop();
+	}
+}
+
+bool ActiveObjectPoolImpl::createWorkers(uint32_t numWorkers, const std::string& name, \
+                                        const IActiveObject::SchedulingPolicy& schedPolicy, WorkerInitFunc&& initFunc)
+{
+	bool isFifo = (schedPolicy == IActiveObject::SchedulingPolicy::Fifo);
+
+	if(numWorkers == 0)
+	{
+		numWorkers = std::thread::hardware_concurrency();
+	}
+	if(numWorkers == 0)
+	{
+		numWorkers = 1;
+	}
+
+	m_scheduler = std::make_shared<WorkStealingScheduler>(name);
+
+	return m_scheduler->start(numWorkers, isFifo, std::move(initFunc));
+}
+
+IActiveObjectPool::ReturnCode ActiveObjectPoolImpl::executeFunction(AOFunc&& func)
+{
+	return m_scheduler->scheduleFunction(std::move(func));
+}
+
+uint32_t ActiveObjectPoolImpl::getNumWorkers() const
+{
+	return m_scheduler->getNumWorkers();
+}
+
+IActiveObjectPool::Statistics ActiveObjectPoolImpl::getStatistics() const
+{
+	Statistics statistics;
+	m_scheduler->getStatistics(statistics.executedFunctions, statistics.stolenFunctions);
+	return statistics;
+}
+
+} // namespace V1
+
+} // namespace ActiveObject
+
+} // namespace UtilsFramework
@@ -3,6 +3,8 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 #include <string.h>
+#include <functional>
+#include <algorithm>
 
 #include "activeObjectThread.h"
 
@@ -11,10 +13,31 @@ namespace UtilsFramework::ActiveObject::implementation
 
 using namespace UtilsFramework::EventLoop::V1;
 
-ActiveObjectThread::ActiveObjectThread(const std::string& name)
+ActiveObjectThread::ActiveObjectThread(const std::string& name, QueueOptions&& queueOptions)
     :   m_name(name),
-        m_eventFd(-1)
+        m_eventFd(-1),
+        m_isWakeupPending(false),
+        m_isWeighted(false),
+        m_level(PriorityCount - 1),
+        m_credit(0),
+        m_queueOptions(std::move(queueOptions)),
+        m_depth(0),
+        m_maxDepth(0),
+        m_isDropOldest(m_queueOptions.capacity != 0 && \
+                    m_queueOptions.overflowPolicy == UtilsFramework::ActiveObject::V1::IActiveObject::OverflowPolicy::DropOldest),
+        m_isAboveHighWatermark(false),
+        m_rejectedFunctions(0),
+        m_droppedFunctions(0),
+        m_blockedCalls(0),
+        m_blockedProducers(0),
+        m_isStopRequested(false)
 {
+	for(uint32_t priority = 0; priority < PriorityCount; ++priority)
+	{
+		m_queueDepths[priority].store(0, std::memory_order_relaxed);
+		m_weights[priority].store(0, std::memory_order_relaxed);
+	}
+
     // Should add a trace point here in the future for debugging
 }
 
@@ -29,8 +52,14 @@ ActiveObjectThread::~ActiveObjectThread()
 		ActiveObjectThread::stopEventLoop(m_eventFd);
 	} else
 	{
-		/* If AO termination came from main thread -> schedule an event for AO thread to stop its eventLoop */
-		scheduleFunction(std::bind(&ActiveObjectThread::stopEventLoop, m_eventFd));
+		/* If AO termination came from main thread -> ask AO thread to stop its eventLoop once every queued function
+		*  has been executed. Not queued as a function, so that neither the capacity nor DropOldest apply to it. */
+		m_isStopRequested.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(!m_isWakeupPending.exchange(true, std::memory_order_acq_rel))
+		{
+			notify();
+		}
 		m_thread.join();
 	}
     }
@@ -41,30 +70,31 @@ ActiveObjectThread::~ActiveObjectThread()
     }
 }
 
-bool ActiveObjectThread::start(bool isFifo, const AOFunc& initFunc)
+bool ActiveObjectThread::start(bool isFifo, AOFunc&& initFunc)
 {
 	/* Create an event fd to synchronize with AO Thread.
-	*  When main thread schedule an event/task for AO thread, it will notify AO Thread by writing to this fd */
-	m_eventFd = eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE);
+	*  When main thread schedule an event/task for AO thread, it will notify AO Thread by writing to this fd.
+	*  A single read consumes all notifications, since every read is followed by draining the whole queue. */
+	m_eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
 	if(m_eventFd == -1)
 	{
 		return false;
 	}
 
 	/* Give the AO Thread this m_eventFd, ask it to monitor on this fd. If any scheduled event has been enqueued, main thread will notify it via this fd. */
-	m_thread = std::thread(&ActiveObjectThread::mainFunction, m_name, m_eventFd, std::bind(&ActiveObjectThread::handleFdEvent, this), isFifo, initFunc);
+	m_thread = std::thread(&ActiveObjectThread::mainFunction, m_name, m_eventFd, std::bind(&ActiveObjectThread::handleFdEvent, this), isFifo, std::move(initFunc));
 
 	return true;
 }
 
 void ActiveObjectThread::mainFunction(const std::string& name, int eventFd, \
-                    const IEventLoop::CallbackFunc& fdHandler, \
-                    bool isFifo, const AOFunc& initFunc)
+                    IEventLoop::CallbackFunc&& fdHandler, \
+                    bool isFifo, AOFunc&& initFunc)
 {
 	prctl(PR_SET_NAME, name.c_str(), 0, 0, 0);
 
 	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
-	if(eventLoop.addFdHandler(eventFd, IEventLoop::FdEventIn, fdHandler) != IEventLoop::ReturnCode::NORMAL)
+	if(eventLoop.addFdHandler(eventFd, IEventLoop::FdEventIn, std::move(fdHandler)) != IEventLoop::ReturnCode::NORMAL)
 	{
 		return;
 	}
@@ -96,11 +126,214 @@ void ActiveObjectThread::stopEventLoop(int eventFd)
 	eventLoop.stop();
 }
 
-void ActiveObjectThread::scheduleFunction(const AOFunc& func)
+ActiveObjectThread::ReturnCode ActiveObjectThread::scheduleFunction(AOFunc&& func, uint32_t priority)
+{
+	using OverflowPolicy = UtilsFramework::ActiveObject::V1::IActiveObject::OverflowPolicy;
+
+	/* The AO Thread calls every function it takes, refuse an empty one before it counts in the depth */
+	if(!func)
+	{
+		return ReturnCode::INVALID_ARG;
+	}
+
+	if(priority >= PriorityCount)
+	{
+		priority = PriorityCount - 1;
+	}
+
+	size_t depth = 0;
+	if(m_queueOptions.capacity == 0)
+	{
+		depth = m_depth.fetch_add(1, std::memory_order_seq_cst) + 1;
+	} else if(!tryReserve(depth))
+	{
+		switch(m_queueOptions.overflowPolicy)
+		{
+		case OverflowPolicy::Reject:
+			m_rejectedFunctions.fetch_add(1, std::memory_order_relaxed);
+			return ReturnCode::QUEUE_FULL;
+
+		case OverflowPolicy::DropNewest:
+			m_droppedFunctions.fetch_add(1, std::memory_order_relaxed);
+			return ReturnCode::DROPPED;
+
+		case OverflowPolicy::DropOldest:
+			m_droppedFunctions.fetch_add(1, std::memory_order_relaxed);
+			if(!dropOldestFunction())
+			{
+				/* Every queued function is still being linked by its producer, drop the new one instead */
+				return ReturnCode::DROPPED;
+			}
+
+			/* One function in, one out: the depth does not change */
+			pushFunction(std::move(func), priority);
+			return ReturnCode::NORMAL;
+
+		case OverflowPolicy::Block:
+		default:
+			if(m_thread.get_id() == std::this_thread::get_id())
+			{
+				/* The AO Thread would wait for itself, go over the capacity instead */
+				depth = m_depth.fetch_add(1, std::memory_order_seq_cst) + 1;
+				break;
+			}
+
+			m_blockedCalls.fetch_add(1, std::memory_order_relaxed);
+			{
+				std::unique_lock<std::mutex> lock(m_blockMutex);
+				m_blockedProducers.fetch_add(1, std::memory_order_seq_cst);
+				m_notFull.wait(lock, [this, &depth]() { return tryReserve(depth); });
+				m_blockedProducers.fetch_sub(1, std::memory_order_relaxed);
+			}
+			break;
+		}
+	}
+
+	onDepthIncreased(depth);
+	pushFunction(std::move(func), priority);
+	return ReturnCode::NORMAL;
+}
+
+void ActiveObjectThread::pushFunction(AOFunc&& func, uint32_t priority)
+{
+	/* Enqueue this task to AO Thread task queue, lock-free. The depth is counted before the push so that it never
+	*  goes below zero when the AO Thread pops the function right away */
+	m_queueDepths[priority].fetch_add(1, std::memory_order_relaxed);
+	m_funcQueues[priority].push(std::move(func));
+
+	/* Pairs with the fence in handleFdEvent(): either the AO Thread sees this function when it re-checks the queue,
+	*  or we see m_isWakeupPending cleared. Only the first producer after it was cleared notifies AO Thread. */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(!m_isWakeupPending.exchange(true, std::memory_order_acq_rel))
+	{
+		notify();
+	}
+}
+
+bool ActiveObjectThread::tryReserve(size_t& depth)
 {
-	/* Enqueue this task to AO Thread task queue */
-	enqueueFunction(func);
+	/* seq_cst, failed exchanges included: a blocked producer increments m_blockedProducers then reads the depth here,
+	*  onFunctionTaken() decrements the depth then reads m_blockedProducers. At least one of them sees the other */
+	size_t current = m_depth.load(std::memory_order_seq_cst);
+	while(current < m_queueOptions.capacity)
+	{
+		if(m_depth.compare_exchange_weak(current, current + 1, std::memory_order_seq_cst, std::memory_order_seq_cst))
+		{
+			depth = current + 1;
+			return true;
+		}
+	}
+
+	return false;
+}
 
+void ActiveObjectThread::onDepthIncreased(size_t depth)
+{
+	size_t maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+	while(depth > maxDepth && !m_maxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed))
+	{
+	}
+
+	if(m_queueOptions.highWatermark != 0 && depth >= m_queueOptions.highWatermark && \
+		!m_isAboveHighWatermark.load(std::memory_order_relaxed) && \
+		!m_isAboveHighWatermark.exchange(true, std::memory_order_acq_rel))
+	{
+		if(m_queueOptions.onHighWatermark)
+		{
+			m_queueOptions.onHighWatermark(depth);
+		}
+	}
+}
+
+void ActiveObjectThread::onFunctionTaken()
+{
+	/* seq_cst pairs with m_blockedProducers incremented by a producer before it checks the depth */
+	size_t depth = m_depth.fetch_sub(1, std::memory_order_seq_cst) - 1;
+
+	if(depth <= m_queueOptions.lowWatermark && m_isAboveHighWatermark.load(std::memory_order_relaxed) && \
+		m_isAboveHighWatermark.exchange(false, std::memory_order_acq_rel))
+	{
+		if(m_queueOptions.onLowWatermark)
+		{
+			m_queueOptions.onLowWatermark(depth);
+		}
+	}
+
+	if(m_blockedProducers.load(std::memory_order_seq_cst) > 0)
+	{
+		// Taking the mutex makes sure the producer is either before its check or already waiting
+		std::lock_guard<std::mutex> lock(m_blockMutex);
+		m_notFull.notify_one();
+	}
+}
+
+bool ActiveObjectThread::dropOldestFunction()
+{
+	/* The oldest function of the lowest non-empty level goes first. It is destroyed after the lock is released. */
+	AOFunc dropped;
+	for(uint32_t priority = PriorityCount; priority > 0; --priority)
+	{
+		if(takeFunction(priority - 1, dropped))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ActiveObjectThread::takeFunction(uint32_t priority, AOFunc& func)
+{
+	std::unique_lock<std::mutex> lock(m_dropMutex, std::defer_lock);
+	if(m_isDropOldest)
+	{
+		lock.lock();
+	}
+
+	if(!m_funcQueues[priority].pop(func))
+	{
+		return false;
+	}
+
+	m_queueDepths[priority].fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+void ActiveObjectThread::setWeights(const std::array<uint32_t, PriorityCount>& weights)
+{
+	bool isWeighted = false;
+	for(uint32_t priority = 0; priority < PriorityCount; ++priority)
+	{
+		m_weights[priority].store(weights[priority], std::memory_order_relaxed);
+		isWeighted = isWeighted || (weights[priority] != 0);
+	}
+
+	m_isWeighted.store(isWeighted, std::memory_order_relaxed);
+}
+
+size_t ActiveObjectThread::getQueueDepth(uint32_t priority) const
+{
+	if(priority >= PriorityCount)
+	{
+		return 0;
+	}
+
+	return m_queueDepths[priority].load(std::memory_order_relaxed);
+}
+
+ActiveObjectThread::QueueStatistics ActiveObjectThread::getQueueStatistics() const
+{
+	QueueStatistics statistics;
+	statistics.depth = m_depth.load(std::memory_order_relaxed);
+	statistics.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+	statistics.rejectedFunctions = m_rejectedFunctions.load(std::memory_order_relaxed);
+	statistics.droppedFunctions = m_droppedFunctions.load(std::memory_order_relaxed);
+	statistics.blockedCalls = m_blockedCalls.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+void ActiveObjectThread::notify()
+{
 	/* Notify AO Thread via m_eventFd */
 	uint64_t one = 1;
 	ssize_t len = ::write(m_eventFd, &one, sizeof(one));
@@ -110,45 +343,112 @@ void ActiveObjectThread::scheduleFunction(const AOFunc& func)
 	}
 }
 
-void ActiveObjectThread::enqueueFunction(const AOFunc& func)
+void ActiveObjectThread::handleFdEvent()
 {
-	/* We will lock this mutex and unlock it right when exiting this function.
-	*  So if any other main threads that also owns this AO Thread will not be able to enqueue at a same time. 
-	*  To avoid race condition or collision */
-	std::lock_guard<std::mutex> lock(m_mutex);
+	uint64_t counter;
+	(void)::read(m_eventFd, &counter, sizeof(counter));
+
+	uint32_t executed = 0;
+	while(true)
+	{
+		uint32_t batchStart = executed;
+		AOFunc func;
+		while(executed < MaxFunctionsPerWakeup && popFunction(func))
+		{
+			func();
+			func = nullptr;
+			++executed;
+		}
+
+		if(executed >= MaxFunctionsPerWakeup)
+		{
+			/* Keep m_isWakeupPending set and come back after the other FDs of this Event Loop */
+			notify();
+			return;
+		}
+
+		if(m_isStopRequested.load(std::memory_order_relaxed) && isQueueEmpty())
+		{
+			/* Every function queued before the AO was released has been executed */
+			ActiveObjectThread::stopEventLoop(m_eventFd);
+			return;
+		}
 
-	m_funcQueue.push_back(func);
+		/* Let producers notify again, then re-check the queue for functions pushed meanwhile */
+		m_isWakeupPending.store(false, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if((isQueueEmpty() && !m_isStopRequested.load(std::memory_order_relaxed)) || m_isWakeupPending.exchange(true, std::memory_order_acq_rel))
+		{
+			return;
+		}
+
+		if(executed == batchStart)
+		{
+			/* A producer is in the middle of push(), do not spin until it links its function */
+			notify();
+			return;
+		}
+	}
 }
 
-ActiveObjectThread::AOFunc ActiveObjectThread::dequeueFunction()
+bool ActiveObjectThread::popFunction(AOFunc& func)
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_isWeighted.load(std::memory_order_relaxed))
+	{
+		/* Strict: always the highest non-empty level, checked again before each function */
+		for(uint32_t priority = 0; priority < PriorityCount; ++priority)
+		{
+			if(takeFunction(priority, func))
+			{
+				onFunctionTaken();
+				return true;
+			}
+		}
+
+		/* The first turn after switching to weights starts with Urgent */
+		m_level = PriorityCount - 1;
+		m_credit = 0;
+		return false;
+	}
 
-	AOFunc func;
-	auto func_it = m_funcQueue.begin();
-	if(func_it != m_funcQueue.end())
+	/* Weighted: a turn takes up to the weight of functions from each level, Urgent first. m_level == PriorityCount - 1
+	*  with no credit left means the next turn starts. Every level is visited once before giving up */
+	for(uint32_t visited = 0; visited <= PriorityCount; ++visited)
 	{
-		func = *func_it;
-		m_funcQueue.erase(func_it);
+		if(m_credit > 0 && takeFunction(m_level, func))
+		{
+			--m_credit;
+			onFunctionTaken();
+			return true;
+		}
+
+		m_level = (m_level + 1) % PriorityCount;
+		m_credit = std::max<uint32_t>(m_weights[m_level].load(std::memory_order_relaxed), 1);
 	}
 
-	return func;
+	/* Nothing queued, whatever comes next starts a new turn with Urgent */
+	m_level = PriorityCount - 1;
+	m_credit = 0;
+	return false;
 }
 
-void ActiveObjectThread::handleFdEvent()
+bool ActiveObjectThread::isQueueEmpty()
 {
-	uint64_t sem_count;
-	ssize_t len = ::read(m_eventFd, &sem_count, sizeof(sem_count));
-	if(len == -1)
+	std::unique_lock<std::mutex> lock(m_dropMutex, std::defer_lock);
+	if(m_isDropOldest)
 	{
-		return;
+		lock.lock();
 	}
 
-	auto func = dequeueFunction();
-	if(func)
+	for(const auto& funcQueue : m_funcQueues)
 	{
-		func();
+		if(!funcQueue.empty())
+		{
+			return false;
+		}
 	}
+
+	return true;
 }
 
 } // namespace UtilsFramework::ActiveObject::implementation
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include "workStealingScheduler.h"
+
+namespace UtilsFramework::ActiveObject::implementation
+{
+
+using namespace UtilsFramework::EventLoop::V1;
+
+namespace
+{
+/* Scheduler and worker index of the calling thread, when it is a worker */
+thread_local const WorkStealingScheduler* t_scheduler = nullptr;
+thread_local uint32_t t_workerIndex = 0;
+}
+
+WorkStealingScheduler::WorkStealingScheduler(const std::string& name)
+    :   m_name(name),
+        m_numWorkers(0),
+        m_nextWorker(0),
+        m_idleWorkers(0),
+        m_isStopping(false),
+        m_activeSubmitters(0)
+{
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		Worker& worker = m_workers[i];
+
+		/* Only left when a worker could not start */
+		AOFunc* func = nullptr;
+		while(worker.inbox.pop(func) || worker.deque.pop(func))
+		{
+			delete func;
+		}
+
+		if(worker.eventFd != -1)
+		{
+			close(worker.eventFd);
+		}
+	}
+}
+
+bool WorkStealingScheduler::start(uint32_t numWorkers, bool isFifo, WorkerInitFunc&& initFunc)
+{
+	m_initFunc = std::move(initFunc);
+	m_workers.reset(new Worker[numWorkers]);
+	m_numWorkers = numWorkers;
+	m_idleWorkers.store(numWorkers, std::memory_order_relaxed);
+
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		Worker& worker = m_workers[i];
+		worker.index = i;
+		worker.eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if(worker.eventFd == -1)
+		{
+			return false;
+		}
+	}
+
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		// Each worker reports whether its Event Loop is monitoring its eventFd, so that functions can be given right away
+		std::promise<bool> started;
+		std::future<bool> isStarted = started.get_future();
+		m_workers[i].thread = std::thread(&WorkStealingScheduler::workerMain, shared_from_this(), std::ref(m_workers[i]), isFifo, std::move(started));
+		if(!isStarted.get())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void WorkStealingScheduler::stop()
+{
+	/* Pairs with scheduleFunction(): either the submitter sees m_isStopping, or the workers see it active */
+	m_isStopping.store(true, std::memory_order_seq_cst);
+
+	/* Wake every worker up, even busy ones: each of them stops once it finds no function left anywhere */
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		if(m_workers[i].eventFd != -1)
+		{
+			notify(m_workers[i]);
+		}
+	}
+
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		Worker& worker = m_workers[i];
+		if(!worker.thread.joinable())
+		{
+			continue;
+		}
+
+		if(worker.thread.get_id() == std::this_thread::get_id())
+		{
+			/* The pool is released by one of its own functions -> this worker stops by itself after the function */
+			worker.thread.detach();
+		} else
+		{
+			worker.thread.join();
+		}
+	}
+}
+
+void WorkStealingScheduler::workerMain(std::shared_ptr<WorkStealingScheduler> self, Worker& worker, bool isFifo, \
+                    std::promise<bool> started)
+{
+	std::string name = self->m_name + "-" + std::to_string(worker.index);
+	prctl(PR_SET_NAME, name.c_str(), 0, 0, 0);
+
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	WorkStealingScheduler* scheduler = self.get();
+	if(eventLoop.addFdHandler(worker.eventFd, IEventLoop::FdEventIn, [scheduler, &worker](int, uint32_t) { scheduler->handleFdEvent(worker); }) != IEventLoop::ReturnCode::NORMAL)
+	{
+		started.set_value(false);
+		return;
+	}
+
+	if(isFifo)
+	{
+		int policy;
+		struct sched_param param;
+		pthread_getschedparam(pthread_self(), &policy, &param);
+		pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	}
+
+	t_scheduler = scheduler;
+	t_workerIndex = worker.index;
+	worker.threadId = std::this_thread::get_id();
+	started.set_value(true);
+
+	if(self->m_initFunc)
+	{
+		self->m_initFunc(worker.index);
+	}
+
+	/* Functions given before this point are picked up at the first wakeup */
+	if(self->claimWakeup(worker))
+	{
+		notify(worker);
+	}
+
+	eventLoop.run();
+	t_scheduler = nullptr;
+}
+
+WorkStealingScheduler::ReturnCode WorkStealingScheduler::scheduleFunction(AOFunc&& func)
+{
+	/* Workers call every function they take, refuse an empty one before it is allocated */
+	if(!func)
+	{
+		return ReturnCode::INVALID_ARG;
+	}
+
+	if(t_scheduler == this)
+	{
+		/* Given by one of our workers: keep it local, an idle worker may steal it. Even while stopping, this worker
+		*  finds it before it can end. */
+		m_workers[t_workerIndex].deque.push(new AOFunc(std::move(func)));
+		wakeIdleWorker(t_workerIndex);
+		return ReturnCode::NORMAL;
+	}
+
+	m_activeSubmitters.fetch_add(1, std::memory_order_seq_cst);
+	if(m_isStopping.load(std::memory_order_seq_cst))
+	{
+		m_activeSubmitters.fetch_sub(1, std::memory_order_seq_cst);
+		return ReturnCode::STOPPED;
+	}
+
+	Worker& worker = m_workers[m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_numWorkers];
+	worker.inbox.push(new AOFunc(std::move(func)));
+
+	/* Pairs with the fence in handleFdEvent(), see ActiveObjectThread::scheduleFunction() */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(claimWakeup(worker))
+	{
+		notify(worker);
+	}
+
+	/* The last access: once it drops to zero while stopping, the workers may end and release the scheduler */
+	m_activeSubmitters.fetch_sub(1, std::memory_order_seq_cst);
+	return ReturnCode::NORMAL;
+}
+
+uint32_t WorkStealingScheduler::getNumWorkers() const
+{
+	return m_numWorkers;
+}
+
+void WorkStealingScheduler::getStatistics(uint64_t& executedFunctions, uint64_t& stolenFunctions) const
+{
+	executedFunctions = 0;
+	stolenFunctions = 0;
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		executedFunctions += m_workers[i].executedFunctions.load(std::memory_order_relaxed);
+		stolenFunctions += m_workers[i].stolenFunctions.load(std::memory_order_relaxed);
+	}
+}
+
+void WorkStealingScheduler::handleFdEvent(Worker& worker)
+{
+	uint64_t counter;
+	(void)::read(worker.eventFd, &counter, sizeof(counter));
+
+	uint32_t executed = 0;
+	while(true)
+	{
+		uint32_t batchStart = executed;
+		AOFunc* func = nullptr;
+		while(executed < MaxFunctionsPerWakeup && takeFunction(worker, func))
+		{
+			(*func)();
+			delete func;
+			++executed;
+		}
+		worker.executedFunctions.fetch_add(executed - batchStart, std::memory_order_relaxed);
+
+		if(executed >= MaxFunctionsPerWakeup)
+		{
+			/* Keep isWakeupPending set and come back after the other FDs of this Event Loop */
+			notify(worker);
+			return;
+		}
+
+		if(m_isStopping.load(std::memory_order_seq_cst))
+		{
+			if(m_activeSubmitters.load(std::memory_order_seq_cst) != 0)
+			{
+				/* Another thread is giving a function which may land in any inbox, come back until it is done. This
+				*  only lasts for the few instructions of scheduleFunction(). */
+				notify(worker);
+				return;
+			}
+
+			if(!hasFunctions(worker))
+			{
+				IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+				(void)eventLoop.removeFdHandler(worker.eventFd);
+				(void)eventLoop.stop();
+				return;
+			}
+		}
+
+		/* Go idle, then re-check for functions given meanwhile, to this worker or to any deque it could steal from */
+		worker.isWakeupPending.store(false, std::memory_order_relaxed);
+		m_idleWorkers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(!hasFunctions(worker) || !claimWakeup(worker))
+		{
+			return;
+		}
+
+		if(executed == batchStart)
+		{
+			/* A producer is in the middle of push() or another worker won the steal, do not spin */
+			notify(worker);
+			return;
+		}
+	}
+}
+
+bool WorkStealingScheduler::takeFunction(Worker& worker, AOFunc*& func)
+{
+	if(worker.deque.pop(func))
+	{
+		return true;
+	}
+
+	/* Move what other threads gave to this worker to its deque, where idle workers can steal it */
+	uint32_t moved = 0;
+	AOFunc* given = nullptr;
+	while(moved < MaxFunctionsPerWakeup && worker.inbox.pop(given))
+	{
+		worker.deque.push(given);
+		++moved;
+	}
+
+	if(moved > 1)
+	{
+		wakeIdleWorker(worker.index);
+	}
+	if(moved > 0 && worker.deque.pop(func))
+	{
+		return true;
+	}
+
+	/* Steal the oldest function of the other workers, starting with the next one */
+	for(uint32_t i = 1; i < m_numWorkers; ++i)
+	{
+		Worker& victim = m_workers[(worker.index + i) % m_numWorkers];
+		if(victim.deque.steal(func))
+		{
+			worker.stolenFunctions.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WorkStealingScheduler::hasFunctions(Worker& worker) const
+{
+	if(!worker.inbox.empty())
+	{
+		return true;
+	}
+
+	for(uint32_t i = 0; i < m_numWorkers; ++i)
+	{
+		if(!m_workers[i].deque.empty())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WorkStealingScheduler::claimWakeup(Worker& worker)
+{
+	if(worker.isWakeupPending.exchange(true, std::memory_order_acq_rel))
+	{
+		return false;
+	}
+
+	m_idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+void WorkStealingScheduler::wakeIdleWorker(uint32_t fromIndex)
+{
+	/* Pairs with the fence in handleFdEvent(): either an idle worker sees the new function, or we see it idle */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(m_idleWorkers.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	for(uint32_t i = 1; i < m_numWorkers; ++i)
+	{
+		Worker& worker = m_workers[(fromIndex + i) % m_numWorkers];
+		if(!worker.isWakeupPending.load(std::memory_order_relaxed) && claimWakeup(worker))
+		{
+			notify(worker);
+			return;
+		}
+	}
+}
+
+void WorkStealingScheduler::notify(const Worker& worker)
+{
+	uint64_t one = 1;
+	ssize_t len = ::write(worker.eventFd, &one, sizeof(one));
+	if(len == -1)
+	{
+		// Print ERROR
+	}
+}
+
+} // namespace UtilsFramework::ActiveObject::implementation
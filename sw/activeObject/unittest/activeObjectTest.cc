@@ -0,0 +1,416 @@
+#include <iostream>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "activeObjectIf.h"
+#include "activeObjectPoolIf.h"
+#include "futureIf.h"
+#include "eventLoopIf.h"
+
+using namespace UtilsFramework::ActiveObject::V1;
+using namespace UtilsFramework::EventLoop::V1;
+
+namespace
+{
+
+// Waits until flag is set, gives up after 5 seconds so that a failing test does not hang
+bool waitFor(const std::atomic<bool>& flag)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while(!flag.load())
+	{
+		if(std::chrono::steady_clock::now() > deadline)
+		{
+			return false;
+		}
+		std::this_thread::yield();
+	}
+
+	return true;
+}
+
+// Queues a function keeping the AO thread busy until release is set, returns once it is running
+void blockActiveObject(IActiveObject& activeObject, std::atomic<bool>& release)
+{
+	std::atomic<bool> isRunning{false};
+	(void)activeObject.executeFunction([&isRunning, &release]()
+	{
+		isRunning = true;
+		while(!release.load())
+		{
+			std::this_thread::yield();
+		}
+	});
+	(void)waitFor(isRunning);
+}
+
+// Queues 4 Background, 4 Normal then 1 Urgent functions before the AO thread takes its first one, returns their
+// execution order
+std::string runPriorityOrder(uint32_t urgentWeight, uint32_t normalWeight, uint32_t backgroundWeight)
+{
+	std::atomic<bool> release{false};
+	std::shared_ptr<IActiveObject> activeObject = IActiveObject::create("priorityTest", [&release]()
+	{
+		(void)waitFor(release);
+	});
+	activeObject->setPriorityWeights(urgentWeight, normalWeight, backgroundWeight);
+
+	std::string order;
+	for(int i = 0; i < 4; ++i)
+	{
+		(void)activeObject->executeFunction([&order]() { order += 'B'; }, IActiveObject::Priority::Background);
+	}
+	for(int i = 0; i < 4; ++i)
+	{
+		(void)activeObject->executeFunction([&order]() { order += 'N'; });
+	}
+	(void)activeObject->executeFunction([&order]() { order += 'U'; }, IActiveObject::Priority::Urgent);
+
+	// Queued last at the lowest level, so it runs after every other function in both modes
+	std::atomic<bool> isDone{false};
+	(void)activeObject->executeFunction([&isDone]() { isDone = true; }, IActiveObject::Priority::Background);
+	release = true;
+	(void)waitFor(isDone);
+	activeObject.reset();
+	return order;
+}
+
+} // namespace
+
+int main()
+{
+	// Producers do not write the eventfd while the AO thread has a wakeup pending: 1000 functions, one wakeup
+	std::shared_ptr<IActiveObject> activeObject = IActiveObject::create("wakeupTest");
+	uint64_t wakeupsBefore = 0;
+	uint64_t wakeupsAfter = 0;
+	std::atomic<bool> isDone{false};
+	(void)activeObject->executeFunction([&wakeupsBefore, &isDone]()
+	{
+		wakeupsBefore = IEventLoop::getThreadLocalInstance().getEpollStatistics().wakeups;
+		isDone = true;
+	});
+	(void)waitFor(isDone);
+
+	std::atomic<bool> release{false};
+	blockActiveObject(*activeObject, release);
+	std::atomic<uint32_t> executed{0};
+	for(int i = 0; i < 1000; ++i)
+	{
+		(void)activeObject->executeFunction([&executed]() { ++executed; });
+	}
+	size_t queuedDepth = activeObject->getQueueDepth(IActiveObject::Priority::Normal);
+	isDone = false;
+	(void)activeObject->executeFunction([&wakeupsAfter, &isDone]()
+	{
+		wakeupsAfter = IEventLoop::getThreadLocalInstance().getEpollStatistics().wakeups;
+		isDone = true;
+	});
+	release = true;
+	if(!waitFor(isDone) || executed != 1000 || queuedDepth != 1000 || wakeupsAfter - wakeupsBefore > 2)
+	{
+		std::cout << "[FAILED] - IActiveObject.executeFunction() wakeups = " << wakeupsAfter - wakeupsBefore << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject.executeFunction()" << std::endl;
+	}
+
+
+	// An empty function is refused, it is neither queued nor called by the AO thread
+	IActiveObject::ReturnCode emptyRc = activeObject->executeFunction(nullptr);
+	size_t emptyDepth = activeObject->getQueueStatistics().depth;
+	isDone = false;
+	(void)activeObject->executeFunction([&isDone]() { isDone = true; });
+	if(emptyRc != IActiveObject::ReturnCode::INVALID_ARG || emptyDepth != 0 || !waitFor(isDone))
+	{
+		std::cout << "[FAILED] - IActiveObject.executeFunction() with an empty function" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject.executeFunction() with an empty function" << std::endl;
+	}
+
+
+	// Releasing the AO executes every function already queued before its thread is joined
+	std::atomic<bool> releaseLater{false};
+	blockActiveObject(*activeObject, releaseLater);
+	executed = 0;
+	for(int i = 0; i < 100; ++i)
+	{
+		(void)activeObject->executeFunction([&executed]() { ++executed; });
+	}
+	std::thread releaser([&releaseLater]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		releaseLater = true;
+	});
+	activeObject.reset();
+	releaser.join();
+	if(executed != 100)
+	{
+		std::cout << "[FAILED] - IActiveObject stops after draining its queue, executed = " << executed << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject stops after draining its queue" << std::endl;
+	}
+
+
+	// Strict: Urgent, then Normal, then Background. Weighted 1/2/1: every turn starts with Urgent
+	std::string strictOrder = runPriorityOrder(0, 0, 0);
+	std::string weightedOrder = runPriorityOrder(1, 2, 1);
+	if(strictOrder != "UNNNNBBBB" || weightedOrder != "UNNBNNBBB")
+	{
+		std::cout << "[FAILED] - IActiveObject.setPriorityWeights(), strict = " << strictOrder << ", weighted = " << weightedOrder << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject.setPriorityWeights()" << std::endl;
+	}
+
+
+	// Reject and DropNewest refuse the function, DropOldest drops the oldest queued one right away
+	IActiveObject::ReturnCode overflowRcs[3];
+	IActiveObject::QueueStatistics overflowStats[3];
+	size_t dropOldestDepth = 0;
+	std::string dropOldestOrder;
+	const IActiveObject::OverflowPolicy overflowPolicies[3] = {IActiveObject::OverflowPolicy::Reject, \
+					IActiveObject::OverflowPolicy::DropNewest, IActiveObject::OverflowPolicy::DropOldest};
+	for(int i = 0; i < 3; ++i)
+	{
+		IActiveObject::QueueOptions queueOptions;
+		queueOptions.capacity = 2;
+		queueOptions.overflowPolicy = overflowPolicies[i];
+		std::shared_ptr<IActiveObject> boundedAo = IActiveObject::create("boundedTest", std::move(queueOptions));
+
+		std::string order;
+		std::atomic<bool> releaseBounded{false};
+		blockActiveObject(*boundedAo, releaseBounded);
+		(void)boundedAo->executeFunction([&order]() { order += '1'; });
+		(void)boundedAo->executeFunction([&order]() { order += '2'; });
+		overflowRcs[i] = boundedAo->executeFunction([&order]() { order += '3'; });
+		dropOldestDepth = boundedAo->getQueueDepth(IActiveObject::Priority::Normal);
+		overflowStats[i] = boundedAo->getQueueStatistics();
+		releaseBounded = true;
+		boundedAo.reset();
+		dropOldestOrder = order;
+	}
+	if(overflowRcs[0] != IActiveObject::ReturnCode::QUEUE_FULL || overflowStats[0].rejectedFunctions != 1 ||
+		overflowRcs[1] != IActiveObject::ReturnCode::DROPPED || overflowStats[1].droppedFunctions != 1 ||
+		overflowRcs[2] != IActiveObject::ReturnCode::NORMAL || overflowStats[2].droppedFunctions != 1 ||
+		overflowStats[2].depth != 2 || dropOldestDepth != 2 || dropOldestOrder != "23")
+	{
+		std::cout << "[FAILED] - IActiveObject OverflowPolicy Reject/DropNewest/DropOldest" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject OverflowPolicy Reject/DropNewest/DropOldest" << std::endl;
+	}
+
+
+	// Block waits for the AO thread to take a function, watermarks are reported once per crossing
+	std::atomic<uint32_t> highWatermarks{0};
+	std::atomic<uint32_t> lowWatermarks{0};
+	IActiveObject::QueueOptions blockOptions;
+	blockOptions.capacity = 4;
+	blockOptions.overflowPolicy = IActiveObject::OverflowPolicy::Block;
+	blockOptions.highWatermark = 3;
+	blockOptions.lowWatermark = 1;
+	blockOptions.onHighWatermark = [&highWatermarks](size_t) { ++highWatermarks; };
+	blockOptions.onLowWatermark = [&lowWatermarks](size_t) { ++lowWatermarks; };
+	std::shared_ptr<IActiveObject> blockingAo = IActiveObject::create("blockTest", std::move(blockOptions));
+	std::atomic<bool> releaseBlocking{false};
+	blockActiveObject(*blockingAo, releaseBlocking);
+	std::thread unblocker([&releaseBlocking]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		releaseBlocking = true;
+	});
+	executed = 0;
+	for(int i = 0; i < 6; ++i)
+	{
+		(void)blockingAo->executeFunction([&executed]() { ++executed; });
+	}
+	unblocker.join();
+	IActiveObject::QueueStatistics blockStats = blockingAo->getQueueStatistics();
+	blockingAo.reset();
+	if(executed != 6 || blockStats.blockedCalls == 0 || blockStats.maxDepth != 4 || highWatermarks == 0 ||
+		highWatermarks != lowWatermarks)
+	{
+		std::cout << "[FAILED] - IActiveObject OverflowPolicy Block and watermarks" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject OverflowPolicy Block and watermarks" << std::endl;
+	}
+
+
+	// Functions given by a worker stay on its deque, idle workers steal them
+	std::shared_ptr<IActiveObjectPool> pool = IActiveObjectPool::create(4);
+	std::atomic<uint32_t> children{0};
+	isDone = false;
+	IActiveObjectPool::ReturnCode poolRc = pool->executeFunction([&pool, &children, &isDone]()
+	{
+		for(int i = 0; i < 64; ++i)
+		{
+			(void)pool->executeFunction([&children, &isDone]()
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				if(++children == 64)
+				{
+					isDone = true;
+				}
+			});
+		}
+	});
+	IActiveObjectPool::ReturnCode emptyPoolRc = pool->executeFunction(nullptr);
+	if(poolRc != IActiveObjectPool::ReturnCode::NORMAL || !waitFor(isDone) || pool->getStatistics().stolenFunctions == 0 ||
+		pool->getNumWorkers() != 4 || emptyPoolRc != IActiveObjectPool::ReturnCode::INVALID_ARG)
+	{
+		std::cout << "[FAILED] - IActiveObjectPool.executeFunction() from a worker" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObjectPool.executeFunction() from a worker" << std::endl;
+	}
+
+
+	// While the pool stops, its workers still give functions, other threads are refused
+	std::atomic<IActiveObjectPool::ReturnCode> externalRc{IActiveObjectPool::ReturnCode::NORMAL};
+	std::atomic<bool> workerFunctionRan{false};
+	IActiveObjectPool* stoppingPool = pool.get();
+	(void)pool->executeFunction([stoppingPool, &externalRc, &workerFunctionRan]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		std::thread external([stoppingPool, &externalRc]()
+		{
+			externalRc = stoppingPool->executeFunction([]() {});
+		});
+		external.join();
+		(void)stoppingPool->executeFunction([&workerFunctionRan]() { workerFunctionRan = true; });
+	});
+	pool.reset();
+	if(externalRc != IActiveObjectPool::ReturnCode::STOPPED || !workerFunctionRan)
+	{
+		std::cout << "[FAILED] - IActiveObjectPool stopping" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObjectPool stopping" << std::endl;
+	}
+
+
+	// The pool can also be released by one of its own functions
+	pool = IActiveObjectPool::create(2);
+	isDone = false;
+	(void)pool->executeFunction([&pool, &isDone]()
+	{
+		pool.reset();
+		isDone = true;
+	});
+	if(!waitFor(isDone))
+	{
+		std::cout << "[FAILED] - IActiveObjectPool released from a worker" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObjectPool released from a worker" << std::endl;
+	}
+
+
+	// A result handed over from an AO to a pool, then back to the thread setting it
+	std::shared_ptr<IActiveObject> producerAo = IActiveObject::create("futureTest");
+	pool = IActiveObjectPool::create(2);
+	std::atomic<size_t> chainResult{0};
+	isDone = false;
+	Future<void> chained = producerAo->submit([]() { return 12345; })
+		.then(*pool, [](int value) { return std::to_string(value); })
+		.then([&chainResult, &isDone](std::string text)
+		{
+			chainResult = text.size();
+			isDone = true;
+		});
+
+	Future<int> ready = producerAo->submit([]() { return 42; });
+	int readyValue = 0;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while(!ready.tryGet(readyValue) && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	if(!waitFor(isDone) || chainResult != 5 || readyValue != 42 || ready.isValid() || !chained.isValid())
+	{
+		std::cout << "[FAILED] - IActiveObject.submit() and Future.then()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IActiveObject.submit() and Future.then()" << std::endl;
+	}
+
+
+	// Shared states go back to the free list of the releasing thread, and are taken from it again
+	using StatePool = Detail::SharedStatePool<sizeof(Detail::SharedState<int>)>;
+	void* firstState = StatePool::getThreadLocalInstance().allocate();
+	StatePool::getThreadLocalInstance().deallocate(firstState);
+	void* secondState = StatePool::getThreadLocalInstance().allocate();
+	StatePool::getThreadLocalInstance().deallocate(secondState);
+	if(firstState != secondState)
+	{
+		std::cout << "[FAILED] - Future shared state reuse" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - Future shared state reuse" << std::endl;
+	}
+
+
+	// A Promise destroyed without its value breaks its Future, the rest of the chain is dropped
+	bool continuationRan = false;
+	Future<void> afterAbandoned;
+	{
+		Promise<int> promise;
+		afterAbandoned = promise.getFuture().then([&continuationRan](int) { continuationRan = true; });
+	}
+	if(!afterAbandoned.isBroken() || afterAbandoned.isReady() || continuationRan)
+	{
+		std::cout << "[FAILED] - Future.isBroken()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - Future.isBroken()" << std::endl;
+	}
+
+
+	// A function or continuation refused by its executor breaks the Future, the rest of the chain is dropped
+	IActiveObject::QueueOptions rejectOptions;
+	rejectOptions.capacity = 1;
+	rejectOptions.overflowPolicy = IActiveObject::OverflowPolicy::Reject;
+	std::shared_ptr<IActiveObject> fullAo = IActiveObject::create("brokenTest", std::move(rejectOptions));
+	std::atomic<bool> releaseFull{false};
+	blockActiveObject(*fullAo, releaseFull);
+	(void)fullAo->executeFunction([]() {});
+
+	Future<int> refused = fullAo->submit([]() { return 1; });
+	bool isRefusedBroken = refused.isBroken();
+	Future<void> afterRefused = std::move(refused).then([&continuationRan](int) { continuationRan = true; });
+
+	isDone = false;
+	Future<int> refusedContinuation = producerAo->submit([]() { return 2; })
+		.then(*fullAo, [&continuationRan](int value) { continuationRan = true; return value; });
+	(void)producerAo->executeFunction([&isDone]() { isDone = true; });
+	(void)waitFor(isDone);
+	releaseFull = true;
+	fullAo.reset();
+	if(!isRefusedBroken || !afterRefused.isBroken() || !refusedContinuation.isBroken() || continuationRan)
+	{
+		std::cout << "[FAILED] - Future.isBroken() on a refused function or continuation" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - Future.isBroken() on a refused function or continuation" << std::endl;
+	}
+
+	return 0;
+}
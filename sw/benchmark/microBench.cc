@@ -0,0 +1,390 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "logHistogram.h"
+#include "eventLoopIf.h"
+#include "eventLoopImpl.h"
+#include "activeObjectIf.h"
+#include "activeObjectPoolIf.h"
+
+using namespace UtilsFramework::EventLoop::V1;
+using namespace UtilsFramework::ActiveObject::V1;
+using namespace UtilsFramework::Common::V1;
+
+/* Micro-benchmarks of the Event Loop and the Active Object, printed as one JSON document on stdout so that results of
+*  two releases can be compared by a script:
+* + ao_eventfd_ping_pong:       round trip of an eventfd token between the Event Loops of two Active Objects
+* + eventloop_dispatch_fds_<N>: one runOnce() iteration dispatching N always-ready eventfds
+* + eventloop_schedule_event:   scheduleEvent() plus execution by the next iteration, per event
+* + ao_execute_function_<P>:    IActiveObject::executeFunction() call time with P producer threads
+* + ao_pool_fan_out_<W>:        binary tree of small tasks spawned from the workers of an IActiveObjectPool of W workers
+*
+* Every entry has a latency histogram summary in nanoseconds and a throughput in operations per second.
+*
+*  Usage: microBench [scale] [maxProducers] */
+
+namespace
+{
+
+struct BenchResult
+{
+	std::string name;
+	std::string latencyOf;
+	uint64_t operations;
+	double seconds;
+	LogHistogram latencyNs;
+};
+
+int64_t nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BenchResult benchPingPong(uint64_t roundTrips)
+{
+	BenchResult result{"ao_eventfd_ping_pong", "round trip", roundTrips, 0.0, {}};
+
+	int pingFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	int pongFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	std::promise<void> done;
+	uint64_t count = 0;
+	int64_t sentNs = 0;
+
+	// The pong side sends every token straight back
+	std::shared_ptr<IActiveObject> pong = IActiveObject::create("benchPong", [pingFd, pongFd]()
+	{
+		(void)IEventLoop::getThreadLocalInstance().addFdHandler(pingFd, IEventLoop::FdEventIn, [pongFd](int fd, uint32_t) -> void
+		{
+			uint64_t value;
+			if(::read(fd, &value, sizeof(value)) == sizeof(value))
+			{
+				(void)::write(pongFd, &value, sizeof(value));
+			}
+		});
+	});
+
+	// The ping side measures the round trip and sends the next token
+	std::shared_ptr<IActiveObject> ping = IActiveObject::create("benchPing", [&, pingFd, pongFd]()
+	{
+		(void)IEventLoop::getThreadLocalInstance().addFdHandler(pongFd, IEventLoop::FdEventIn, [&, pingFd](int fd, uint32_t) -> void
+		{
+			uint64_t value;
+			if(::read(fd, &value, sizeof(value)) != sizeof(value))
+			{
+				return;
+			}
+
+			int64_t receivedNs = nowNs();
+			result.latencyNs.record(static_cast<uint64_t>(receivedNs - sentNs));
+			if(++count == roundTrips)
+			{
+				done.set_value();
+				return;
+			}
+
+			sentNs = nowNs();
+			(void)::write(pingFd, &value, sizeof(value));
+		});
+	});
+
+	if(!ping || !pong)
+	{
+		return result;
+	}
+
+	int64_t startNs = nowNs();
+	ping->executeFunction([&sentNs, pingFd]()
+	{
+		uint64_t one = 1;
+		sentNs = nowNs();
+		(void)::write(pingFd, &one, sizeof(one));
+	});
+	done.get_future().wait();
+	result.seconds = static_cast<double>(nowNs() - startNs) / 1e9;
+
+	// Stop both Active Objects before their FDs are closed
+	ping.reset();
+	pong.reset();
+	close(pingFd);
+	close(pongFd);
+	return result;
+}
+
+BenchResult benchDispatch(uint32_t numFds, uint64_t iterations)
+{
+	BenchResult result{"eventloop_dispatch_fds_" + std::to_string(numFds), "iteration", iterations * numFds, 0.0, {}};
+
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	(void)eventLoop.setEpollBatchSize(numFds, numFds);
+
+	// Never read, so every FD stays ready and each iteration dispatches all of them
+	std::vector<int> fds(numFds);
+	uint64_t dispatched = 0;
+	for(uint32_t i = 0; i < numFds; ++i)
+	{
+		fds[i] = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+		(void)eventLoop.addFdHandler(fds[i], IEventLoop::FdEventIn, [&dispatched](int, uint32_t) -> void
+		{
+			++dispatched;
+		});
+	}
+
+	int64_t startNs = nowNs();
+	for(uint64_t i = 0; i < iterations; ++i)
+	{
+		uint32_t count = 0;
+		int64_t iterationStartNs = nowNs();
+		(void)eventLoop.runOnce(std::chrono::nanoseconds(0), count);
+		result.latencyNs.record(static_cast<uint64_t>(nowNs() - iterationStartNs));
+	}
+	result.seconds = static_cast<double>(nowNs() - startNs) / 1e9;
+	result.operations = dispatched;
+
+	for(int fd : fds)
+	{
+		(void)eventLoop.removeFdHandler(fd);
+		close(fd);
+	}
+	EventLoopImpl::reset();
+	return result;
+}
+
+BenchResult benchScheduleEvent(uint32_t batchSize, uint64_t batches)
+{
+	BenchResult result{"eventloop_schedule_event", "event, per batch of " + std::to_string(batchSize), batches * batchSize, 0.0, {}};
+
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+
+	uint64_t executed = 0;
+	int64_t startNs = nowNs();
+	for(uint64_t batch = 0; batch < batches; ++batch)
+	{
+		int64_t batchStartNs = nowNs();
+		for(uint32_t i = 0; i < batchSize; ++i)
+		{
+			(void)eventLoop.scheduleEvent([&executed]() -> void
+			{
+				++executed;
+			});
+		}
+
+		uint32_t count = 0;
+		(void)eventLoop.runOnce(std::chrono::nanoseconds(0), count);
+		result.latencyNs.record(static_cast<uint64_t>(nowNs() - batchStartNs) / batchSize);
+	}
+	result.seconds = static_cast<double>(nowNs() - startNs) / 1e9;
+	result.operations = executed;
+
+	EventLoopImpl::reset();
+	return result;
+}
+
+BenchResult benchExecuteFunction(uint32_t numProducers, uint64_t callsPerProducer)
+{
+	BenchResult result{"ao_execute_function_" + std::to_string(numProducers), "executeFunction() call",
+		numProducers * callsPerProducer, 0.0, {}};
+
+	std::shared_ptr<IActiveObject> ao = IActiveObject::create("benchConsumer");
+	if(!ao)
+	{
+		return result;
+	}
+
+	// Only touched by the AO thread
+	uint64_t executed = 0;
+	uint64_t total = numProducers * callsPerProducer;
+	std::promise<void> done;
+
+	std::atomic<bool> isStarted(false);
+	std::vector<LogHistogram> histograms(numProducers);
+	std::vector<std::thread> producers;
+	for(uint32_t p = 0; p < numProducers; ++p)
+	{
+		producers.emplace_back([&, p]()
+		{
+			while(!isStarted.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+
+			for(uint64_t i = 0; i < callsPerProducer; ++i)
+			{
+				int64_t callStartNs = nowNs();
+				ao->executeFunction([&executed, &done, total]()
+				{
+					if(++executed == total)
+					{
+						done.set_value();
+					}
+				});
+				histograms[p].record(static_cast<uint64_t>(nowNs() - callStartNs));
+			}
+		});
+	}
+
+	// Throughput is measured until the AO has executed the last function, not only until it was submitted
+	int64_t startNs = nowNs();
+	isStarted.store(true, std::memory_order_release);
+	for(std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	done.get_future().wait();
+	result.seconds = static_cast<double>(nowNs() - startNs) / 1e9;
+
+	for(const LogHistogram& histogram : histograms)
+	{
+		result.latencyNs.merge(histogram);
+	}
+	return result;
+}
+
+/* Index of the pool worker running the calling thread, set by the WorkerInitFunc */
+thread_local uint32_t t_benchWorker = 0;
+
+struct FanOut
+{
+	IActiveObjectPool* pool;
+	std::vector<LogHistogram>* histograms;  /*!< One per worker, only touched by that worker */
+	std::atomic<uint64_t> remaining;
+	std::promise<void> done;
+};
+
+void fanOut(FanOut* fanOutCtx, uint32_t depth, int64_t submittedNs)
+{
+	(*fanOutCtx->histograms)[t_benchWorker].record(static_cast<uint64_t>(nowNs() - submittedNs));
+
+	if(depth > 0)
+	{
+		for(int child = 0; child < 2; ++child)
+		{
+			int64_t childSubmittedNs = nowNs();
+			fanOutCtx->pool->executeFunction([fanOutCtx, depth, childSubmittedNs]() { fanOut(fanOutCtx, depth - 1, childSubmittedNs); });
+		}
+	} else
+	{
+		// Leaves stand for a small CPU-bound job
+		volatile uint64_t work = 0;
+		for(uint32_t i = 0; i < 256; ++i)
+		{
+			work = work + i;
+		}
+	}
+
+	if(fanOutCtx->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		fanOutCtx->done.set_value();
+	}
+}
+
+BenchResult benchPoolFanOut(uint32_t numWorkers, uint32_t depth, uint64_t numTrees)
+{
+	uint64_t tasksPerTree = (uint64_t(2) << depth) - 1;
+	BenchResult result{"ao_pool_fan_out_" + std::to_string(numWorkers), "task queueing delay", numTrees * tasksPerTree, 0.0, {}};
+
+	std::vector<LogHistogram> histograms(numWorkers);
+	std::shared_ptr<IActiveObjectPool> pool = IActiveObjectPool::create(numWorkers, [](uint32_t workerIndex)
+	{
+		t_benchWorker = workerIndex;
+	}, "benchPool");
+	if(!pool)
+	{
+		return result;
+	}
+
+	FanOut fanOutCtx{pool.get(), &histograms, {result.operations}, {}};
+	std::future<void> isDone = fanOutCtx.done.get_future();
+
+	int64_t startNs = nowNs();
+	for(uint64_t tree = 0; tree < numTrees; ++tree)
+	{
+		int64_t submittedNs = nowNs();
+		pool->executeFunction([&fanOutCtx, depth, submittedNs]() { fanOut(&fanOutCtx, depth, submittedNs); });
+	}
+	isDone.wait();
+	result.seconds = static_cast<double>(nowNs() - startNs) / 1e9;
+
+	// Workers are joined before reading their histograms
+	pool.reset();
+	for(const LogHistogram& histogram : histograms)
+	{
+		result.latencyNs.merge(histogram);
+	}
+	return result;
+}
+
+void printResult(std::ostream& out, const BenchResult& result, bool isLast)
+{
+	const LogHistogram& latency = result.latencyNs;
+	double mean = latency.count() ? static_cast<double>(latency.sum()) / static_cast<double>(latency.count()) : 0.0;
+	double throughput = result.seconds > 0.0 ? static_cast<double>(result.operations) / result.seconds : 0.0;
+
+	out << "    {\n"
+		<< "      \"name\": \"" << result.name << "\",\n"
+		<< "      \"operations\": " << result.operations << ",\n"
+		<< "      \"seconds\": " << result.seconds << ",\n"
+		<< "      \"throughput_per_sec\": " << throughput << ",\n"
+		<< "      \"latency_ns\": {\n"
+		<< "        \"of\": \"" << result.latencyOf << "\",\n"
+		<< "        \"count\": " << latency.count() << ",\n"
+		<< "        \"min\": " << latency.min() << ",\n"
+		<< "        \"mean\": " << mean << ",\n"
+		<< "        \"p50\": " << latency.valueAtPercentile(50.0) << ",\n"
+		<< "        \"p90\": " << latency.valueAtPercentile(90.0) << ",\n"
+		<< "        \"p99\": " << latency.valueAtPercentile(99.0) << ",\n"
+		<< "        \"p999\": " << latency.valueAtPercentile(99.9) << ",\n"
+		<< "        \"max\": " << latency.max() << "\n"
+		<< "      }\n"
+		<< "    }" << (isLast ? "\n" : ",\n");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+	uint32_t maxProducers = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 8;
+	scale = scale == 0 ? 1 : scale;
+	maxProducers = maxProducers == 0 ? 1 : maxProducers;
+
+	std::vector<BenchResult> results;
+	results.push_back(benchPingPong(20000 * scale));
+	for(uint32_t numFds : {1U, 16U, 256U, 1024U})
+	{
+		results.push_back(benchDispatch(numFds, (1000000 * scale) / numFds + 100));
+	}
+	results.push_back(benchScheduleEvent(1000, 1000 * scale));
+	for(uint32_t numProducers = 1; numProducers <= maxProducers; numProducers *= 2)
+	{
+		results.push_back(benchExecuteFunction(numProducers, (200000 * scale) / numProducers));
+	}
+	for(uint32_t numWorkers = 1; numWorkers <= maxProducers; numWorkers *= 2)
+	{
+		results.push_back(benchPoolFanOut(numWorkers, 16, 4 * scale));
+	}
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "{\n"
+		<< "  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "  \"benchmarks\": [\n";
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		printResult(std::cout, results[i], i + 1 == results.size());
+	}
+	std::cout << "  ]\n"
+		<< "}" << std::endl;
+
+	return 0;
+}
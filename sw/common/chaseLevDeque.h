@@ -0,0 +1,184 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace UtilsFramework
+{
+namespace Common
+{
+namespace V1
+{
+
+/*! @brief Unbounded lock-free work-stealing deque (Chase-Lev, with the memory orderings of Le et al., "Correct and
+* Efficient Work-Stealing for Weak Memory Models").
+* + push() and pop() must only be called by the owner thread, which works LIFO on the bottom end.
+* + steal() can be called from any thread and takes the oldest element on the top end.
+*
+* steal() returns false both when the deque is empty and when it lost a race against pop() or another steal(), so
+* thieves should move on to another deque rather than spin. T must be trivially copyable (typically a pointer): a
+* thief reads an element before knowing whether it won it. Arrays replaced when growing are only freed along with the
+* deque, as a thief may still be reading them. */
+template <typename T>
+class ChaseLevDeque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "ChaseLevDeque - T must be trivially copyable!");
+
+public:
+	/*! @param[in] capacity Initial capacity, rounded up to a power of two */
+	explicit ChaseLevDeque(size_t capacity = 1024)
+		: m_top(0),
+		  m_bottom(0)
+	{
+		size_t powerOfTwo = 2;
+		while(powerOfTwo < capacity)
+		{
+			powerOfTwo <<= 1;
+		}
+
+		m_arrays.push_back(std::make_unique<Array>(powerOfTwo));
+		m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+	}
+
+	// First prevent copy/move construtors
+	ChaseLevDeque(const ChaseLevDeque&)               = delete;
+	ChaseLevDeque(ChaseLevDeque&&)                    = delete;
+	ChaseLevDeque& operator=(const ChaseLevDeque&)    = delete;
+	ChaseLevDeque& operator=(ChaseLevDeque&&)         = delete;
+
+	void push(T value)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		int64_t top = m_top.load(std::memory_order_acquire);
+		Array* array = m_array.load(std::memory_order_relaxed);
+		if(bottom - top > static_cast<int64_t>(array->mask))
+		{
+			array = grow(array, top, bottom);
+		}
+
+		array->put(bottom, value);
+		// Publishes the element (and what it points to) to the thieves which read m_bottom
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	bool pop(T& value)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		Array* array = m_array.load(std::memory_order_relaxed);
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_relaxed);
+
+		if(top > bottom)
+		{
+			// Empty
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		value = array->get(bottom);
+		if(top == bottom)
+		{
+			// Last element, thieves may be after it as well
+			bool isWon = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return isWon;
+		}
+
+		return true;
+	}
+
+	bool steal(T& value)
+	{
+		int64_t top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_bottom.load(std::memory_order_acquire);
+		if(top >= bottom)
+		{
+			return false;
+		}
+
+		Array* array = m_array.load(std::memory_order_acquire);
+		T candidate = array->get(top);
+		if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		value = candidate;
+		return true;
+	}
+
+	/*! @brief Approximate when called by another thread than the owner */
+	bool empty() const
+	{
+		return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+	}
+
+	size_t size() const
+	{
+		int64_t size = m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed);
+		return size > 0 ? static_cast<size_t>(size) : 0;
+	}
+
+private:
+	struct Array
+	{
+		explicit Array(size_t capacity)
+			: mask(capacity - 1),
+			  slots(new std::atomic<T>[capacity])
+		{
+		}
+
+		T get(int64_t index) const
+		{
+			return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T value)
+		{
+			slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+		}
+
+		const size_t mask;
+		std::unique_ptr<std::atomic<T>[]> slots;
+	};
+
+	Array* grow(Array* array, int64_t top, int64_t bottom)
+	{
+		m_arrays.push_back(std::make_unique<Array>((array->mask + 1) * 2));
+		Array* bigger = m_arrays.back().get();
+		for(int64_t index = top; index < bottom; ++index)
+		{
+			bigger->put(index, array->get(index));
+		}
+
+		m_array.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	// The owner and the thieves work on different cache lines
+	alignas(64) std::atomic<int64_t> m_top;
+	alignas(64) std::atomic<int64_t> m_bottom;
+	std::atomic<Array*> m_array;
+	std::vector<std::unique_ptr<Array>> m_arrays;     /*!< Current and replaced arrays, only touched by the owner */
+
+}; // class ChaseLevDeque
+
+} // namespace V1
+
+} // namespace Common
+
+} // namespace UtilsFramework
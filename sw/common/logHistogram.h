@@ -0,0 +1,148 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <limits>
+
+namespace UtilsFramework
+{
+namespace Common
+{
+namespace V1
+{
+
+/*! @brief Fixed-size histogram of uint64_t values with logarithmic buckets, in the spirit of HdrHistogram.
+* Every power of two range [2^n, 2^(n+1)) is split into SubBuckets linear buckets, so any recorded value is known
+* with a relative error below 1 / SubBuckets (12.5%) over the full uint64_t range, using 4KB and no allocation.
+* Values below SubBuckets are exact.
+*
+* record() is a handful of instructions (one count leading zeros, no loop, no branch misprediction in steady state).
+* Not thread-safe: record and read from the same thread. */
+class LogHistogram
+{
+public:
+	static constexpr uint32_t SubBucketBits = 3;
+	static constexpr uint32_t SubBuckets    = 1U << SubBucketBits;
+	static constexpr size_t BucketCount     = (64 - SubBucketBits + 1) * SubBuckets;
+
+	void record(uint64_t value)
+	{
+		++m_buckets[bucketIndex(value)];
+		++m_count;
+		m_sum += value;
+		m_min = value < m_min ? value : m_min;
+		m_max = value > m_max ? value : m_max;
+	}
+
+	/*! @brief Add the values of another histogram, e.g. one recorded by another thread */
+	void merge(const LogHistogram& other)
+	{
+		for(size_t i = 0; i < BucketCount; ++i)
+		{
+			m_buckets[i] += other.m_buckets[i];
+		}
+		m_count += other.m_count;
+		m_sum += other.m_sum;
+		m_min = other.m_min < m_min ? other.m_min : m_min;
+		m_max = other.m_max > m_max ? other.m_max : m_max;
+	}
+
+	void reset()
+	{
+		m_buckets.fill(0);
+		m_count = 0;
+		m_sum = 0;
+		m_min = std::numeric_limits<uint64_t>::max();
+		m_max = 0;
+	}
+
+	uint64_t count() const { return m_count; }
+	uint64_t sum() const { return m_sum; }
+	uint64_t min() const { return m_count ? m_min : 0; }
+	uint64_t max() const { return m_max; }
+
+	/*! @brief Smallest bucket upper bound below which at least percentile % of the recorded values are, clamped to
+	* max(). Returns 0 if nothing has been recorded. */
+	uint64_t valueAtPercentile(double percentile) const
+	{
+		if(m_count == 0)
+		{
+			return 0;
+		}
+
+		double threshold = percentile / 100.0 * static_cast<double>(m_count);
+		uint64_t cumulative = 0;
+		for(size_t i = 0; i < BucketCount; ++i)
+		{
+			cumulative += m_buckets[i];
+			if(cumulative > 0 && static_cast<double>(cumulative) >= threshold)
+			{
+				uint64_t upperBound = bucketUpperBound(i);
+				return upperBound < m_max ? upperBound : m_max;
+			}
+		}
+
+		return m_max;
+	}
+
+	/*! @brief Calls func(uint64_t upperBound, uint64_t count) for each non-empty bucket, in increasing order */
+	template <typename Func>
+	void forEachBucket(Func&& func) const
+	{
+		for(size_t i = 0; i < BucketCount; ++i)
+		{
+			if(m_buckets[i])
+			{
+				func(bucketUpperBound(i), m_buckets[i]);
+			}
+		}
+	}
+
+	static size_t bucketIndex(uint64_t value)
+	{
+		if(value < SubBuckets)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		// Bucket group 1 is [8, 16) with a width of 1, group 2 is [16, 32) with a width of 2, and so on
+		uint32_t group = static_cast<uint32_t>(63 - __builtin_clzll(value)) - SubBucketBits + 1;
+		return group * SubBuckets + static_cast<size_t>((value >> (group - 1)) & (SubBuckets - 1));
+	}
+
+	static uint64_t bucketUpperBound(size_t index)
+	{
+		if(index < SubBuckets)
+		{
+			return index;
+		}
+
+		uint32_t group = static_cast<uint32_t>(index / SubBuckets);
+		uint64_t lowerBound = (static_cast<uint64_t>(SubBuckets + index % SubBuckets)) << (group - 1);
+		return lowerBound + ((1ULL << (group - 1)) - 1);
+	}
+
+private:
+	std::array<uint64_t, BucketCount> m_buckets {};
+	uint64_t m_count = 0;
+	uint64_t m_sum = 0;
+	uint64_t m_min = std::numeric_limits<uint64_t>::max();
+	uint64_t m_max = 0;
+
+}; // class LogHistogram
+
+} // namespace V1
+
+} // namespace Common
+
+} // namespace UtilsFramework
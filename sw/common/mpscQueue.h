@@ -0,0 +1,151 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace UtilsFramework
+{
+namespace Common
+{
+namespace V1
+{
+
+/*! @brief Unbounded lock-free Multiple Producers Single Consumer queue (Dmitry Vyukov's intrusive design).
+* + push() can be called from any thread and never blocks: one exchange on the head and one store on the link.
+* + pop() and empty() must only be called by the single consumer thread.
+*
+* A producer is briefly "in the middle of" push() between its exchange and its link store. During that window the
+* consumer sees the queue as empty (pop() returns false) although empty() may already return false. Consumers which
+* go to sleep must therefore re-check empty() after having announced they are sleeping, see IEventLoop::post(). */
+template <typename T>
+class MpscQueue
+{
+public:
+	MpscQueue()
+		: m_head(&m_stub),
+		  m_tail(&m_stub)
+	{
+		m_stub.next.store(nullptr, std::memory_order_relaxed);
+	}
+
+	~MpscQueue()
+	{
+		T value;
+		while(pop(value))
+		{
+		}
+	}
+
+	// First prevent copy/move construtors
+	MpscQueue(const MpscQueue&)               = delete;
+	MpscQueue(MpscQueue&&)                    = delete;
+	MpscQueue& operator=(const MpscQueue&)    = delete;
+	MpscQueue& operator=(MpscQueue&&)         = delete;
+
+	void push(T&& value)
+	{
+		pushNode(new Node(std::move(value)));
+	}
+
+	void push(const T& value)
+	{
+		pushNode(new Node(value));
+	}
+
+	bool pop(T& value)
+	{
+		NodeBase* tail = m_tail;
+		NodeBase* next = tail->next.load(std::memory_order_acquire);
+
+		// Skip the stub node, it never carries a value
+		if(tail == &m_stub)
+		{
+			if(next == nullptr)
+			{
+				return false;
+			}
+			m_tail = next;
+			tail = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if(next != nullptr)
+		{
+			m_tail = next;
+			return takeValue(tail, value);
+		}
+
+		// tail is the last linked node. If head moved on, a producer has not linked its node yet.
+		if(tail != m_head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		// Put the stub back behind the last node so that the last node can be consumed as well
+		pushNode(&m_stub);
+
+		next = tail->next.load(std::memory_order_acquire);
+		if(next != nullptr)
+		{
+			m_tail = next;
+			return takeValue(tail, value);
+		}
+
+		return false;
+	}
+
+	bool empty() const
+	{
+		const NodeBase* tail = m_tail;
+		return tail == &m_stub && tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	struct NodeBase
+	{
+		std::atomic<NodeBase*> next{nullptr};
+	};
+
+	struct Node : NodeBase
+	{
+		explicit Node(T&& v) : value(std::move(v)) {}
+		explicit Node(const T& v) : value(v) {}
+		T value;
+	};
+
+	void pushNode(NodeBase* node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+		NodeBase* prev = m_head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	static bool takeValue(NodeBase* node, T& value)
+	{
+		Node* valueNode = static_cast<Node*>(node);
+		value = std::move(valueNode->value);
+		delete valueNode;
+		return true;
+	}
+
+	// Producers and the consumer work on different cache lines
+	alignas(64) std::atomic<NodeBase*> m_head;
+	alignas(64) NodeBase* m_tail;
+	NodeBase m_stub;
+
+}; // class MpscQueue
+
+} // namespace V1
+
+} // namespace Common
+
+} // namespace UtilsFramework
@@ -0,0 +1,124 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace UtilsFramework
+{
+namespace Common
+{
+namespace V1
+{
+
+/*! @brief Unbounded single-thread FIFO queue on top of a power-of-two ring buffer.
+* + push() and pop() are O(1) and never shift the other elements. When full, the ring doubles its capacity.
+* + The buffer is never shrunk, so a queue reused across loop iterations stops allocating once warmed up.
+* + swap() exchanges the contents of two queues in O(1), which allows draining a snapshot of the queue while
+*   new elements are being pushed.
+*
+* T must be default-constructible and movable. A popped slot is reset to T() so that it releases its resources. */
+template <typename T>
+class RingQueue
+{
+public:
+	explicit RingQueue(size_t initialCapacity = 16)
+		: m_buffer(roundUpToPowerOfTwo(initialCapacity)),
+		  m_head(0),
+		  m_size(0)
+	{
+	}
+
+	// First prevent copy/move construtors
+	RingQueue(const RingQueue&)               = delete;
+	RingQueue(RingQueue&&)                    = delete;
+	RingQueue& operator=(const RingQueue&)    = delete;
+	RingQueue& operator=(RingQueue&&)         = delete;
+
+	void push(T&& value)
+	{
+		if(m_size == m_buffer.size())
+		{
+			grow();
+		}
+
+		m_buffer[(m_head + m_size) & (m_buffer.size() - 1)] = std::move(value);
+		++m_size;
+	}
+
+	/*! @brief Moves the oldest element to value. Returns false if the queue is empty. */
+	bool pop(T& value)
+	{
+		if(m_size == 0)
+		{
+			return false;
+		}
+
+		T& slot = m_buffer[m_head];
+		value = std::move(slot);
+		slot = T();
+		m_head = (m_head + 1) & (m_buffer.size() - 1);
+		--m_size;
+		return true;
+	}
+
+	void swap(RingQueue& other) noexcept
+	{
+		m_buffer.swap(other.m_buffer);
+		std::swap(m_head, other.m_head);
+		std::swap(m_size, other.m_size);
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	size_t size() const
+	{
+		return m_size;
+	}
+
+private:
+	static size_t roundUpToPowerOfTwo(size_t value)
+	{
+		size_t capacity = 1;
+		while(capacity < value)
+		{
+			capacity <<= 1;
+		}
+		return capacity;
+	}
+
+	void grow()
+	{
+		std::vector<T> buffer(m_buffer.size() * 2);
+		for(size_t i = 0; i < m_size; ++i)
+		{
+			buffer[i] = std::move(m_buffer[(m_head + i) & (m_buffer.size() - 1)]);
+		}
+
+		m_buffer.swap(buffer);
+		m_head = 0;
+	}
+
+	std::vector<T> m_buffer;
+	size_t m_head;
+	size_t m_size;
+
+}; // class RingQueue
+
+} // namespace V1
+
+} // namespace Common
+
+} // namespace UtilsFramework
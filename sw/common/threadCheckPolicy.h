@@ -0,0 +1,62 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <thread>
+
+/* Compile-time policies shared by the thread-local modules (EventLoop, TimerManager,...). Like UF_TRACE_COMPILE_LEVEL,
+*  they are selected by build flags, so that a release build pays nothing for what only exists to detect misuse or to
+*  mock system calls, while unit tests keep both:
+* + UF_THREAD_CHECK=0 compiles out the checks that an API is called by the thread owning the instance, which then
+*   never returns NOT_THREAD_LOCAL. Calling it from another thread is undefined behavior in such builds.
+* + UF_DIRECT_SYSCALLS=1 makes system calls directly instead of through the virtual syscall wrappers, see
+*   eventLoopSyscallWrapper.h and timerManagerSyscallWrapper.h. */
+#ifndef UF_THREAD_CHECK
+#define UF_THREAD_CHECK 1
+#endif
+
+#ifndef UF_DIRECT_SYSCALLS
+#define UF_DIRECT_SYSCALLS 0
+#endif
+
+namespace UtilsFramework
+{
+namespace Common
+{
+namespace V1
+{
+
+struct CheckedThreadPolicy
+{
+	static bool isOwner(const std::thread::id& ownerId)
+	{
+		return ownerId == std::this_thread::get_id();
+	}
+};
+
+struct UncheckedThreadPolicy
+{
+	static constexpr bool isOwner(const std::thread::id&)
+	{
+		return true;
+	}
+};
+
+#if UF_THREAD_CHECK
+using ThreadCheckPolicy = CheckedThreadPolicy;
+#else
+using ThreadCheckPolicy = UncheckedThreadPolicy;
+#endif
+
+} // namespace V1
+
+} // namespace Common
+
+} // namespace UtilsFramework
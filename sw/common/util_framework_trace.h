@@ -0,0 +1,127 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <stringUtils.h>
+#include <traceIf.h>
+
+#include "util_framework_tpt_provider.h"
+
+/* Tracing for all modules of the framework. Use it as below, instead of TPT_TRACE(level, SSTR(...)):
+*
+* </code>
+*   UF_TRACE(TRACE_INFO, SSTR_ARGS...);      // e.g. UF_TRACE(TRACE_ERROR, "addFdHandler - Invalid FD ", fd, "!");
+* </code>
+*
+* A trace is gated twice before any of its arguments is formatted:
+* + At compile time: a trace below UF_TRACE_COMPILE_LEVEL is discarded by `if constexpr`, no code is generated for
+*   it at all. For example, build with -DUF_TRACE_COMPILE_LEVEL=UF_TRACE_LEVEL_TRACE_ABN to remove all INFO traces.
+* + At run time: a trace below the runtime level (setTraceLevel(), UF_TRACE_LEVEL environment variable, TRACE_INFO by
+*   default, e.g. UF_TRACE_LEVEL=ABN to opt out of INFO traces) costs one relaxed atomic load and one predictable branch. Traces below TRACE_ERROR can also be sampled,
+*   see setTraceSampling(). */
+
+/* Severity ranks of the trace levels, in increasing order. They do not depend on the values of TRACE_* in traceIf.h,
+*  UF_TRACE() maps a level to its rank by name. */
+#define UF_TRACE_LEVEL_TRACE_INFO   0
+#define UF_TRACE_LEVEL_TRACE_ABN    1
+#define UF_TRACE_LEVEL_TRACE_ERROR  2
+#define UF_TRACE_LEVEL_OFF          3
+
+#ifndef UF_TRACE_COMPILE_LEVEL
+#define UF_TRACE_COMPILE_LEVEL UF_TRACE_LEVEL_TRACE_INFO
+#endif
+
+namespace UtilsFramework
+{
+namespace Trace
+{
+namespace V1
+{
+namespace implementation /* private namespace, use the functions of UtilsFramework::Trace::V1 instead */
+{
+
+inline int getInitialTraceLevel()
+{
+	const char* level = std::getenv("UF_TRACE_LEVEL");
+	if(level != nullptr)
+	{
+		if(strcmp(level, "INFO") == 0)  return UF_TRACE_LEVEL_TRACE_INFO;
+		if(strcmp(level, "ABN") == 0)   return UF_TRACE_LEVEL_TRACE_ABN;
+		if(strcmp(level, "ERROR") == 0) return UF_TRACE_LEVEL_TRACE_ERROR;
+		if(strcmp(level, "OFF") == 0)   return UF_TRACE_LEVEL_OFF;
+	}
+
+	return UF_TRACE_LEVEL_TRACE_INFO;
+}
+
+inline std::atomic<int> traceLevel {getInitialTraceLevel()};
+inline std::atomic<uint32_t> traceSampling {1};
+
+} // namespace implementation
+
+/*! @brief Only traces of this level rank (UF_TRACE_LEVEL_*) or above are emitted. Can be called from any thread. */
+inline void setTraceLevel(int levelRank)
+{
+	implementation::traceLevel.store(levelRank, std::memory_order_relaxed);
+}
+
+inline int getTraceLevel()
+{
+	return implementation::traceLevel.load(std::memory_order_relaxed);
+}
+
+/*! @brief Emit only one of every everyN traces below TRACE_ERROR, counted per trace site and per thread, so that a
+* busy site does not use up the samples of the others. 1, the default, emits all of them. Useful to keep INFO traces
+* of a busy loop enabled without flooding the trace buffers. */
+inline void setTraceSampling(uint32_t everyN)
+{
+	implementation::traceSampling.store(everyN > 0 ? everyN : 1, std::memory_order_relaxed);
+}
+
+/*! @brief siteCounter is the sampling counter of the calling trace site, see UF_TRACE() */
+inline bool isTraceEnabled(int levelRank, uint32_t& siteCounter)
+{
+	if(levelRank < implementation::traceLevel.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	uint32_t everyN = implementation::traceSampling.load(std::memory_order_relaxed);
+	if(everyN == 1 || levelRank >= UF_TRACE_LEVEL_TRACE_ERROR)
+	{
+		return true;
+	}
+
+	return (siteCounter++ % everyN) == 0;
+}
+
+} // namespace V1
+
+} // namespace Trace
+
+} // namespace UtilsFramework
+
+#define UF_TRACE(level, ...)                                                                            \
+	do                                                                                                  \
+	{                                                                                                   \
+		if constexpr (UF_TRACE_LEVEL_##level >= UF_TRACE_COMPILE_LEVEL)                                 \
+		{                                                                                               \
+			static thread_local uint32_t ufTraceSiteCounter = 0;                                        \
+			if(UtilsFramework::Trace::V1::isTraceEnabled(UF_TRACE_LEVEL_##level, ufTraceSiteCounter))   \
+			{                                                                                           \
+				TPT_TRACE(level, SSTR(__VA_ARGS__));                                                    \
+			}                                                                                           \
+		}                                                                                               \
+	} while(0)
@@ -0,0 +1,543 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+/* C++20 coroutine support on top of the Event Loop and the Timer Manager. Header only, and only visible when the
+*  including file is compiled with -std=c++20 or later, the rest of the framework still builds as C++17. */
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "eventLoopIf.h"
+#include "timerManagerIf.h"
+#include "timerSubscriberIf.h"
+
+namespace UtilsFramework
+{
+namespace Coroutine
+{
+namespace V1
+{
+/*! @brief Coroutines suspend on the Event Loop of their thread and are resumed directly from its FD callbacks, timer
+* callbacks or scheduled events, without going through any other queue.
+*
+* Example usage:
+*
+* </code>
+*	using namespace UtilsFramework::Coroutine::V1;
+*
+*	Task<size_t> readSome(AsyncEventLoop loop, int fd, char* buffer, size_t size)
+*	{
+*		if(co_await loop.readable(fd) == 0)
+*		{
+*			co_return 0; // fd could not be registered
+*		}
+*		co_return ::read(fd, buffer, size);
+*	}
+*
+*	Task<> session(AsyncEventLoop loop, int fd)
+*	{
+*		char buffer[256];
+*		size_t size = co_await readSome(loop, fd, buffer, sizeof(buffer));
+*		co_await sleepFor(std::chrono::milliseconds(10));
+*		...
+*	}
+*
+*	session(AsyncEventLoop(), fd).detach();
+*	IEventLoop::getThreadLocalInstance().run();
+* </code>
+*
+* @note Coroutines are not thread-safe: a coroutine must only be awaited, detached and destroyed on the thread owning
+* the Event Loop it suspends on. Exceptions escaping a coroutine call std::terminate(). */
+
+/*! @brief Free lists of coroutine frames, one pool per thread and so one per Event Loop. Frames are rounded up to
+* FrameGranularity bytes, frames bigger than MaxPooledFrameSize and frames beyond MaxFreeFramesPerClass of the same
+* size are given back to the global heap. */
+class FramePool
+{
+public:
+	static constexpr size_t FrameGranularity        = 64;
+	static constexpr size_t MaxPooledFrameSize      = 1024;
+	static constexpr uint32_t MaxFreeFramesPerClass = 64;
+
+	static FramePool& getThreadLocalInstance()
+	{
+		static thread_local FramePool pool;
+		return pool;
+	}
+
+	void* allocate(size_t size)
+	{
+		size_t sizeClass = getSizeClass(size);
+		if(sizeClass == NumSizeClasses)
+		{
+			return ::operator new(size);
+		}
+
+		FreeFrame* frame = m_freeFrames[sizeClass];
+		if(frame != nullptr)
+		{
+			m_freeFrames[sizeClass] = frame->next;
+			--m_freeFrameCounts[sizeClass];
+			return frame;
+		}
+
+		return ::operator new((sizeClass + 1) * FrameGranularity);
+	}
+
+	void deallocate(void* ptr, size_t size) noexcept
+	{
+		size_t sizeClass = getSizeClass(size);
+		if(sizeClass == NumSizeClasses || m_freeFrameCounts[sizeClass] >= MaxFreeFramesPerClass)
+		{
+			::operator delete(ptr);
+			return;
+		}
+
+		FreeFrame* frame = static_cast<FreeFrame*>(ptr);
+		frame->next = m_freeFrames[sizeClass];
+		m_freeFrames[sizeClass] = frame;
+		++m_freeFrameCounts[sizeClass];
+	}
+
+	size_t getFreeFrameCount() const
+	{
+		size_t count = 0;
+		for(uint32_t freeFrameCount : m_freeFrameCounts)
+		{
+			count += freeFrameCount;
+		}
+		return count;
+	}
+
+	~FramePool()
+	{
+		for(FreeFrame* frame : m_freeFrames)
+		{
+			while(frame != nullptr)
+			{
+				FreeFrame* next = frame->next;
+				::operator delete(frame);
+				frame = next;
+			}
+		}
+	}
+
+	// First prevent copy/move construtors
+	FramePool(const FramePool&)               = delete;
+	FramePool(FramePool&&)                    = delete;
+	FramePool& operator=(const FramePool&)    = delete;
+	FramePool& operator=(FramePool&&)         = delete;
+
+private:
+	FramePool() = default;
+
+	struct FreeFrame
+	{
+		FreeFrame* next;
+	};
+
+	static constexpr size_t NumSizeClasses = MaxPooledFrameSize / FrameGranularity;
+
+	/* NumSizeClasses means not pooled */
+	static size_t getSizeClass(size_t size)
+	{
+		return (size == 0 || size > MaxPooledFrameSize) ? NumSizeClasses : (size - 1) / FrameGranularity;
+	}
+
+	FreeFrame* m_freeFrames[NumSizeClasses] = {};
+	uint32_t m_freeFrameCounts[NumSizeClasses] = {};
+
+}; // class FramePool
+
+namespace Detail
+{
+
+struct PromiseBase
+{
+	static void* operator new(size_t size)
+	{
+		return FramePool::getThreadLocalInstance().allocate(size);
+	}
+
+	static void operator delete(void* ptr, size_t size) noexcept
+	{
+		FramePool::getThreadLocalInstance().deallocate(ptr, size);
+	}
+
+	/* Resumes the awaiting coroutine by symmetric transfer, so a chain of finishing tasks does not grow the stack.
+	*  A detached task has nobody to resume and frees itself. */
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+		{
+			PromiseBase& promise = handle.promise();
+			if(promise.continuation)
+			{
+				return promise.continuation;
+			}
+
+			if(promise.isDetached)
+			{
+				handle.destroy();
+			}
+			return std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+	std::suspend_always initial_suspend() const noexcept
+	{
+		return {};
+	}
+
+	FinalAwaiter final_suspend() const noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception() const noexcept
+	{
+		std::terminate();
+	}
+
+	std::coroutine_handle<> continuation;
+	bool isDetached = false;
+};
+
+template <typename T>
+struct PromiseResult
+{
+	template <typename U>
+	void return_value(U&& value)
+	{
+		result.emplace(std::forward<U>(value));
+	}
+
+	std::optional<T> result;
+};
+
+template <>
+struct PromiseResult<void>
+{
+	void return_void() const noexcept
+	{
+	}
+};
+
+} // namespace Detail
+
+/*! @brief Lazily started coroutine returning T. Nothing runs until the Task is either co_await-ed by another
+* coroutine, which is then resumed inline when the Task finishes, or detached. The frame is owned by the Task object,
+* or by itself once detached. A Task must not be destroyed while it is suspended on yield(). */
+template <typename T = void>
+class [[nodiscard]] Task
+{
+public:
+	struct promise_type : Detail::PromiseBase, Detail::PromiseResult<T>
+	{
+		Task get_return_object() noexcept
+		{
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+	};
+
+	Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr))
+	{
+	}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if(this != &other)
+		{
+			if(m_handle)
+			{
+				m_handle.destroy();
+			}
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	~Task()
+	{
+		if(m_handle)
+		{
+			m_handle.destroy();
+		}
+	}
+
+	Task(const Task&)               = delete;
+	Task& operator=(const Task&)    = delete;
+
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			bool await_ready() const noexcept
+			{
+				return !handle || handle.done();
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitingHandle) noexcept
+			{
+				handle.promise().continuation = awaitingHandle;
+				return handle;
+			}
+
+			T await_resume()
+			{
+				if constexpr(!std::is_void_v<T>)
+				{
+					return std::move(*handle.promise().result);
+				}
+			}
+
+			std::coroutine_handle<promise_type> handle;
+		};
+
+		return Awaiter{m_handle};
+	}
+
+	/*! @brief Start the task right now on the calling thread. It runs until its first suspension and frees its frame
+	* by itself when it finishes, its result is dropped. */
+	void detach() &&
+	{
+		std::coroutine_handle<promise_type> handle = std::exchange(m_handle, nullptr);
+		if(handle)
+		{
+			handle.promise().isDetached = true;
+			handle.resume();
+		}
+	}
+
+	bool isDone() const
+	{
+		return !m_handle || m_handle.done();
+	}
+
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle)
+	{
+	}
+
+	std::coroutine_handle<promise_type> m_handle;
+
+}; // class Task
+
+/*! @brief Suspend until the FD is ready. The FD is registered to the Event Loop while suspended and removed before
+* resuming, so it must not already have a FD handler. co_await returns the ready event mask, or 0 if the FD could not
+* be registered, in which case the coroutine does not suspend. */
+class FdAwaitable
+{
+public:
+	FdAwaitable(UtilsFramework::EventLoop::V1::IEventLoop& eventLoop, int fd, uint32_t eventMask)
+		: m_eventLoop(eventLoop), m_fd(fd), m_eventMask(eventMask), m_readyEvents(0), m_isRegistered(false)
+	{
+	}
+
+	/* The coroutine was destroyed while suspended here */
+	~FdAwaitable()
+	{
+		if(m_isRegistered)
+		{
+			(void)m_eventLoop.removeFdHandler(m_fd);
+		}
+	}
+
+	FdAwaitable(const FdAwaitable&)               = delete;
+	FdAwaitable(FdAwaitable&&)                    = delete;
+	FdAwaitable& operator=(const FdAwaitable&)    = delete;
+	FdAwaitable& operator=(FdAwaitable&&)         = delete;
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		using UtilsFramework::EventLoop::V1::IEventLoop;
+		IEventLoop::ReturnCode rc = m_eventLoop.addFdHandler(m_fd, m_eventMask, [this, handle](int, uint32_t eventMask) -> void
+		{
+			m_readyEvents = eventMask;
+			m_isRegistered = false;
+			(void)m_eventLoop.removeFdHandler(m_fd);
+			handle.resume();
+		});
+		m_isRegistered = rc == IEventLoop::ReturnCode::NORMAL;
+		return m_isRegistered;
+	}
+
+	uint32_t await_resume() const noexcept
+	{
+		return m_readyEvents;
+	}
+
+private:
+	UtilsFramework::EventLoop::V1::IEventLoop& m_eventLoop;
+	int m_fd;
+	uint32_t m_eventMask;
+	uint32_t m_readyEvents;
+	bool m_isRegistered;
+
+}; // class FdAwaitable
+
+/*! @brief Suspend until the scheduled events of the current loop iteration, giving FD events a chance to run */
+class YieldAwaitable
+{
+public:
+	explicit YieldAwaitable(UtilsFramework::EventLoop::V1::IEventLoop& eventLoop) : m_eventLoop(eventLoop)
+	{
+	}
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		using UtilsFramework::EventLoop::V1::IEventLoop;
+		return m_eventLoop.scheduleEvent([handle]() -> void
+		{
+			handle.resume();
+		}) == IEventLoop::ReturnCode::NORMAL;
+	}
+
+	void await_resume() const noexcept
+	{
+	}
+
+private:
+	UtilsFramework::EventLoop::V1::IEventLoop& m_eventLoop;
+
+}; // class YieldAwaitable
+
+/*! @brief Suspend for a duration using the Timer Manager of the calling thread. co_await returns false if the timer
+* could not be started, in which case the coroutine does not suspend. */
+class SleepAwaitable : public UtilsFramework::Timer::V1::ITimerSubscriber
+{
+public:
+	explicit SleepAwaitable(std::chrono::milliseconds duration) : m_duration(duration), m_isPending(false), m_isExpired(false)
+	{
+	}
+
+	/* The coroutine was destroyed while suspended here */
+	~SleepAwaitable() override
+	{
+		if(m_isPending)
+		{
+			(void)UtilsFramework::Timer::V1::ITimerManager::getThreadLocalInstance().cancelTimer(this);
+		}
+	}
+
+	SleepAwaitable(const SleepAwaitable&)               = delete;
+	SleepAwaitable(SleepAwaitable&&)                    = delete;
+	SleepAwaitable& operator=(const SleepAwaitable&)    = delete;
+	SleepAwaitable& operator=(SleepAwaitable&&)         = delete;
+
+	bool await_ready() noexcept
+	{
+		m_isExpired = m_duration.count() <= 0;
+		return m_isExpired;
+	}
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		using UtilsFramework::Timer::V1::ITimerManager;
+		m_handle = handle;
+		m_isPending = ITimerManager::getThreadLocalInstance().startTimer(m_duration, this) == ITimerManager::ReturnCode::NORMAL;
+		return m_isPending;
+	}
+
+	bool await_resume() const noexcept
+	{
+		return m_isExpired;
+	}
+
+	void handleTimerExpired(uint32_t) override
+	{
+		m_isPending = false;
+		m_isExpired = true;
+		m_handle.resume();
+	}
+
+private:
+	std::chrono::milliseconds m_duration;
+	std::coroutine_handle<> m_handle;
+	bool m_isPending;
+	bool m_isExpired;
+
+}; // class SleepAwaitable
+
+inline SleepAwaitable sleepFor(std::chrono::milliseconds duration)
+{
+	return SleepAwaitable(duration);
+}
+
+/*! @brief Awaitable view of an Event Loop, by default the one of the calling thread. Cheap to copy. */
+class AsyncEventLoop
+{
+public:
+	explicit AsyncEventLoop(UtilsFramework::EventLoop::V1::IEventLoop& eventLoop =
+		UtilsFramework::EventLoop::V1::IEventLoop::getThreadLocalInstance()) : m_eventLoop(&eventLoop)
+	{
+	}
+
+	FdAwaitable readable(int fd) const
+	{
+		return FdAwaitable(*m_eventLoop, fd, UtilsFramework::EventLoop::V1::IEventLoop::FdEventIn);
+	}
+
+	FdAwaitable writable(int fd) const
+	{
+		return FdAwaitable(*m_eventLoop, fd, UtilsFramework::EventLoop::V1::IEventLoop::FdEventOut);
+	}
+
+	YieldAwaitable yield() const
+	{
+		return YieldAwaitable(*m_eventLoop);
+	}
+
+	UtilsFramework::EventLoop::V1::IEventLoop& getEventLoop() const
+	{
+		return *m_eventLoop;
+	}
+
+private:
+	UtilsFramework::EventLoop::V1::IEventLoop* m_eventLoop;
+
+}; // class AsyncEventLoop
+
+} // namespace V1
+
+} // namespace Coroutine
+
+} // namespace UtilsFramework
+
+#endif // __cplusplus >= 202002L && __has_include(<coroutine>)
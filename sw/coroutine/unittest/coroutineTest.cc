@@ -0,0 +1,102 @@
+#include <iostream>
+#include <chrono>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <eventLoopIf.h>
+#include <coroutineIf.h>
+
+using namespace UtilsFramework::EventLoop::V1;
+using namespace UtilsFramework::Coroutine::V1;
+
+namespace
+{
+
+struct Results
+{
+	uint64_t counter = 0;
+	uint32_t writeEvents = 0;
+	bool isSlept = false;
+	std::chrono::steady_clock::duration sleepTime{0};
+	bool isDone = false;
+};
+
+Task<uint64_t> readCounter(AsyncEventLoop loop, int fd)
+{
+	if(co_await loop.readable(fd) != IEventLoop::FdEventIn)
+	{
+		co_return 0;
+	}
+
+	uint64_t counter = 0;
+	(void)::read(fd, &counter, sizeof(counter));
+	co_return counter;
+}
+
+Task<> writeCounter(AsyncEventLoop loop, int fd)
+{
+	// Let the reader suspend first
+	co_await loop.yield();
+
+	uint64_t counter = 42;
+	(void)::write(fd, &counter, sizeof(counter));
+}
+
+Task<> scenario(AsyncEventLoop loop, int fd, Results& results)
+{
+	writeCounter(loop, fd).detach();
+	results.counter = co_await readCounter(loop, fd);
+
+	auto sleepStart = std::chrono::steady_clock::now();
+	results.isSlept = co_await sleepFor(std::chrono::milliseconds(20));
+	results.sleepTime = std::chrono::steady_clock::now() - sleepStart;
+
+	results.writeEvents = co_await loop.writable(fd);
+	results.isDone = true;
+	loop.getEventLoop().stop();
+}
+
+}
+
+int main()
+{
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+	Results results;
+	scenario(AsyncEventLoop(eventLoop), fd, results).detach();
+	IEventLoop::ReturnCode rc = eventLoop.run();
+	close(fd);
+
+	if(rc != IEventLoop::ReturnCode::NORMAL || !results.isDone || results.counter != 42)
+	{
+		std::cout << "[FAILED] - AsyncEventLoop.readable()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - AsyncEventLoop.readable()" << std::endl;
+	}
+
+
+	if(!results.isSlept || results.sleepTime < std::chrono::milliseconds(20))
+	{
+		std::cout << "[FAILED] - sleepFor()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - sleepFor()" << std::endl;
+	}
+
+
+	// All frames have been freed back to the pool of this thread
+	if(results.writeEvents != IEventLoop::FdEventOut || FramePool::getThreadLocalInstance().getFreeFrameCount() < 3)
+	{
+		std::cout << "[FAILED] - Task frames" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - Task frames" << std::endl;
+	}
+
+	return 0;
+}
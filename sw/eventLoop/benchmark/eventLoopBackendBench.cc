@@ -0,0 +1,147 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+
+#include "eventLoopIf.h"
+#include "eventLoopImpl.h"
+
+using namespace UtilsFramework::EventLoop::V1;
+
+/* Side-by-side comparison of the epoll and io_uring backends of EventLoopImpl.
+*  A number of tokens circulate through a ring of eventfds: each callback consumes the token of its own FD and hands
+*  it over to the next FD. The number of ready FDs per wakeup is therefore roughly the number of tokens.
+*
+*  Usage: eventLoopBackendBench [numFds] [numTokens] [numEvents] */
+
+namespace
+{
+
+struct BenchResult
+{
+	double nsPerEvent;
+	double cpuNsPerEvent;
+	IEventLoop::EpollStatistics stats;
+};
+
+double cpuTimeNs()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_THREAD, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e9 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e3;
+}
+
+bool runBench(IEventLoop::Backend backend, int numFds, int numTokens, uint64_t numEvents, BenchResult& result)
+{
+	// Each run gets a fresh thread-local Event Loop, so that statistics and the backend start from scratch
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	if(eventLoop.setBackend(backend) != IEventLoop::ReturnCode::NORMAL)
+	{
+		return false;
+	}
+
+	std::vector<int> fds(numFds);
+	for(int i = 0; i < numFds; ++i)
+	{
+		fds[i] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	}
+
+	uint64_t dispatched = 0;
+	for(int i = 0; i < numFds; ++i)
+	{
+		int nextFd = fds[(i + 1) % numFds];
+		auto callback = [&eventLoop, &dispatched, numEvents, nextFd](int fd, uint32_t) -> void
+		{
+			uint64_t value;
+			if(::read(fd, &value, sizeof(value)) != sizeof(value))
+			{
+				return;
+			}
+
+			uint64_t one = 1;
+			(void)::write(nextFd, &one, sizeof(one));
+
+			if(++dispatched == numEvents)
+			{
+				eventLoop.stop();
+			}
+		};
+
+		if(eventLoop.addFdHandler(fds[i], IEventLoop::FdEventIn, callback) != IEventLoop::ReturnCode::NORMAL)
+		{
+			return false;
+		}
+	}
+
+	for(int i = 0; i < numTokens; ++i)
+	{
+		uint64_t one = 1;
+		(void)::write(fds[(i * numFds) / numTokens], &one, sizeof(one));
+	}
+
+	double cpuStart = cpuTimeNs();
+	auto start = std::chrono::steady_clock::now();
+	eventLoop.run();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	double cpuElapsed = cpuTimeNs() - cpuStart;
+
+	result.nsPerEvent = static_cast<double>(elapsed) / static_cast<double>(dispatched);
+	result.cpuNsPerEvent = cpuElapsed / static_cast<double>(dispatched);
+	result.stats = eventLoop.getEpollStatistics();
+
+	for(int fd : fds)
+	{
+		(void)eventLoop.removeFdHandler(fd);
+		close(fd);
+	}
+
+	return true;
+}
+
+void printResult(const std::string& name, const BenchResult& result, bool isLast)
+{
+	std::cout << "    {\"backend\": \"" << name << "\""
+		<< ", \"ns_per_event\": " << result.nsPerEvent
+		<< ", \"cpu_ns_per_event\": " << result.cpuNsPerEvent
+		<< ", \"wait_calls\": " << result.stats.epollWaitCalls
+		<< ", \"avg_events_per_wakeup\": " << result.stats.avgEventsPerWakeup
+		<< "}" << (isLast ? "" : ",") << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	int numFds = argc > 1 ? std::atoi(argv[1]) : 256;
+	int numTokens = argc > 2 ? std::atoi(argv[2]) : 64;
+	uint64_t numEvents = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2000000;
+
+	if(numFds <= 0 || numTokens <= 0 || numTokens > numFds || numEvents == 0)
+	{
+		std::cout << "Usage: " << argv[0] << " [numFds] [numTokens <= numFds] [numEvents]" << std::endl;
+		return -1;
+	}
+
+	BenchResult epollResult;
+	BenchResult ioUringResult;
+	bool hasEpoll = runBench(IEventLoop::Backend::Epoll, numFds, numTokens, numEvents, epollResult);
+	bool hasIoUring = runBench(IEventLoop::Backend::IoUring, numFds, numTokens, numEvents, ioUringResult);
+
+	std::cout << "{\"fds\": " << numFds << ", \"tokens\": " << numTokens << ", \"events\": " << numEvents << ", \"results\": [" << std::endl;
+	if(hasEpoll)
+	{
+		printResult("epoll", epollResult, !hasIoUring);
+	}
+	if(hasIoUring)
+	{
+		printResult("io_uring", ioUringResult, true);
+	}
+	std::cout << "]}" << std::endl;
+
+	return hasEpoll ? 0 : -1;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "util_framework_trace.h"
+#include "threadCheckPolicy.h"
+#include "eventLoopIf.h"
+#include "eventLoopImpl.h"
+
+using namespace UtilsFramework::EventLoop::V1;
+using namespace UtilsFramework::Trace::V1;
+
+/* Cost of the compile-time policies of EventLoopImpl (see threadCheckPolicy.h). This file is built twice by the Makefile:
+* + eventLoopPolicyBench: default build, thread ownership checks and virtual syscall wrappers, as used by unit tests.
+* + eventLoopPolicyBenchRelease: built with -DUF_THREAD_CHECK=0 -DUF_DIRECT_SYSCALLS=1 and INFO traces compiled out.
+*
+* Two numbers are reported:
+* + ns_per_dispatch: numFds eventfds are always readable, so every runOnce() dispatches all of them with one
+*   epoll_wait(). This is the per-event cost of the loop itself, without any read()/write() in the callbacks.
+* + ns_per_update: updateFdEvents() with an unchanged mask, i.e. the ownership check and the FdHandler lookup, since
+*   no epoll_ctl() is made for it.
+*
+*  Usage: eventLoopPolicyBench [numFds] [numDispatches] */
+
+namespace
+{
+
+double benchDispatch(int numFds, uint64_t numDispatches)
+{
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	(void)eventLoop.setEpollBatchSize(numFds, numFds);
+
+	std::vector<int> fds(numFds);
+	uint64_t dispatched = 0;
+	for(int i = 0; i < numFds; ++i)
+	{
+		fds[i] = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+		(void)eventLoop.addFdHandler(fds[i], IEventLoop::FdEventIn, [&dispatched](int, uint32_t) -> void
+		{
+			++dispatched;
+		});
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	while(dispatched < numDispatches)
+	{
+		uint32_t count = 0;
+		(void)eventLoop.runOnce(std::chrono::nanoseconds(0), count);
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	for(int fd : fds)
+	{
+		(void)eventLoop.removeFdHandler(fd);
+		close(fd);
+	}
+
+	return static_cast<double>(elapsed) / static_cast<double>(dispatched);
+}
+
+double benchUpdate(uint64_t numUpdates)
+{
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+
+	int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	(void)eventLoop.addFdHandler(fd, IEventLoop::FdEventIn, [](int, uint32_t) -> void {});
+
+	uint64_t failures = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(uint64_t i = 0; i < numUpdates; ++i)
+	{
+		failures += eventLoop.updateFdEvents(fd, IEventLoop::FdEventIn) != IEventLoop::ReturnCode::NORMAL;
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	(void)eventLoop.removeFdHandler(fd);
+	close(fd);
+
+	if(failures != 0)
+	{
+		std::cout << "updateFdEvents() failed " << failures << " times" << std::endl;
+	}
+	return static_cast<double>(elapsed) / static_cast<double>(numUpdates);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	int numFds = argc > 1 ? std::atoi(argv[1]) : 256;
+	uint64_t numDispatches = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+
+	if(numFds <= 0 || numDispatches == 0)
+	{
+		std::cout << "Usage: " << argv[0] << " [numFds] [numDispatches]" << std::endl;
+		return -1;
+	}
+
+	// Traces compiled in are disabled at run time, as in production
+	setTraceLevel(UF_TRACE_LEVEL_OFF);
+
+	std::cout << "{\"thread_check\": " << UF_THREAD_CHECK << ", \"direct_syscalls\": " << UF_DIRECT_SYSCALLS
+		<< ", \"trace_compile_level\": " << UF_TRACE_COMPILE_LEVEL << ", \"fds\": " << numFds
+		<< ", \"ns_per_dispatch\": " << benchDispatch(numFds, numDispatches)
+		<< ", \"ns_per_update\": " << benchUpdate(numDispatches) << "}" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "util_framework_trace.h"
+#include "eventLoopIf.h"
+#include "eventLoopImpl.h"
+
+using namespace UtilsFramework::EventLoop::V1;
+using namespace UtilsFramework::Trace::V1;
+
+/* Cost of the traces on the dispatch path of EventLoopImpl. This file is built twice by the Makefile:
+* + eventLoopTraceBench: all traces compiled in. Measured with the runtime trace level set to OFF, i.e. traces are
+*   compiled in but disabled, and with UF_TRACE_LEVEL_TRACE_INFO, i.e. every trace is formatted and emitted.
+* + eventLoopTraceBenchCompiledOut: built with -DUF_TRACE_COMPILE_LEVEL=UF_TRACE_LEVEL_OFF, no trace code at all.
+*
+* A number of tokens circulate through a ring of eventfds, each callback hands its token over to the next FD.
+*
+*  Usage: eventLoopTraceBench [numFds] [numTokens] [numEvents] */
+
+namespace
+{
+
+double runBench(int numFds, int numTokens, uint64_t numEvents)
+{
+	EventLoopImpl::reset();
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+
+	std::vector<int> fds(numFds);
+	for(int i = 0; i < numFds; ++i)
+	{
+		fds[i] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	}
+
+	uint64_t dispatched = 0;
+	for(int i = 0; i < numFds; ++i)
+	{
+		int nextFd = fds[(i + 1) % numFds];
+		(void)eventLoop.addFdHandler(fds[i], IEventLoop::FdEventIn, [&eventLoop, &dispatched, numEvents, nextFd](int fd, uint32_t) -> void
+		{
+			uint64_t value;
+			if(::read(fd, &value, sizeof(value)) != sizeof(value))
+			{
+				return;
+			}
+
+			uint64_t one = 1;
+			(void)::write(nextFd, &one, sizeof(one));
+
+			if(++dispatched == numEvents)
+			{
+				eventLoop.stop();
+			}
+		});
+	}
+
+	for(int i = 0; i < numTokens; ++i)
+	{
+		uint64_t one = 1;
+		(void)::write(fds[(i * numFds) / numTokens], &one, sizeof(one));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	eventLoop.run();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	for(int fd : fds)
+	{
+		(void)eventLoop.removeFdHandler(fd);
+		close(fd);
+	}
+
+	return static_cast<double>(elapsed) / static_cast<double>(dispatched);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	int numFds = argc > 1 ? std::atoi(argv[1]) : 64;
+	int numTokens = argc > 2 ? std::atoi(argv[2]) : 16;
+	uint64_t numEvents = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2000000;
+
+	if(numFds <= 0 || numTokens <= 0 || numTokens > numFds || numEvents == 0)
+	{
+		std::cout << "Usage: " << argv[0] << " [numFds] [numTokens <= numFds] [numEvents]" << std::endl;
+		return -1;
+	}
+
+	std::cout << "{\"fds\": " << numFds << ", \"tokens\": " << numTokens << ", \"events\": " << numEvents << ", \"results\": [" << std::endl;
+#if UF_TRACE_COMPILE_LEVEL >= UF_TRACE_LEVEL_OFF
+	std::cout << "    {\"tracing\": \"compiled_out\", \"ns_per_event\": " << runBench(numFds, numTokens, numEvents) << "}" << std::endl;
+#else
+	setTraceLevel(UF_TRACE_LEVEL_OFF);
+	double disabledNs = runBench(numFds, numTokens, numEvents);
+	setTraceLevel(UF_TRACE_LEVEL_TRACE_INFO);
+	double enabledNs = runBench(numFds, numTokens, numEvents);
+
+	std::cout << "    {\"tracing\": \"compiled_in_disabled\", \"ns_per_event\": " << disabledNs << "}," << std::endl;
+	std::cout << "    {\"tracing\": \"compiled_in_enabled\", \"ns_per_event\": " << enabledNs << "}" << std::endl;
+#endif
+	std::cout << "]}" << std::endl;
+
+	return 0;
+}
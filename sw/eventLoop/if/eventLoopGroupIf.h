@@ -0,0 +1,103 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eventLoopIf.h"
+
+namespace UtilsFramework
+{
+namespace EventLoop
+{
+namespace V1
+{
+/*! @brief Event Loop Group runs N Event Loops, each one on its own thread, optionally pinned to a CPU.
+* It is the multi-reactor counterpart of IEventLoop::getThreadLocalInstance(): instead of managing threads by hand,
+* a service registers its FDs to the group, which spreads them over the loops, and posts work to a given loop or to
+* any of them. Each FD callback and posted function is executed by the thread of its loop, where
+* IEventLoop::getThreadLocalInstance() returns that loop, so other modules (TimerManager,...) also work from there.
+*
+* Example usage:
+*
+* </code>
+*   IEventLoopGroup::Options options;
+*   options.cpus = {2, 3, 4, 5};    // 4 loops, pinned to CPUs 2..5
+*   auto group = IEventLoopGroup::create(options);
+*
+*   group->addFdHandler(clientFd, IEventLoop::FdEventIn, [](int fd, uint32_t eventMask) { ... });
+*   group->post([]() { ... }, 2);   // Executed by the 3rd loop
+* </code>
+*
+* All functions can be called from any thread. Registration functions wait until the loop owning the FD has carried
+* out the request, so two loops must not call them towards each other at the same time. Destroying the group stops
+* all loops and joins their threads, FDs still registered are removed but not closed. */
+class IEventLoopGroup
+{
+public:
+	using ReturnCode = IEventLoop::ReturnCode;
+
+	enum class BalancingPolicy
+	{
+		RoundRobin,     /*!< New FDs go to the loops in turn */
+		LeastLoaded     /*!< New FDs go to the loop with the fewest FDs registered through the group */
+	};
+
+	struct Options
+	{
+		uint32_t numLoops = 0;                      /*!< 0 means one per CPU in cpus, or one per online CPU */
+		std::vector<int> cpus;                      /*!< Loop i is pinned to cpus[i % cpus.size()], none if empty */
+		BalancingPolicy balancingPolicy = BalancingPolicy::RoundRobin;
+		IEventLoop::Backend backend = IEventLoop::Backend::Epoll;
+		std::string name = "EventLoopGroup";        /*!< Loop threads are named <name>-<index> */
+	};
+
+	/*! @brief Index meaning "choose one" for addFdHandler() and post() */
+	static constexpr uint32_t AnyLoop = UINT32_MAX;
+
+	/*! @brief Starts the loop threads and returns once all loops are running. Returns nullptr if a thread could not be
+	* started or pinned, or if options.backend is not supported. */
+	static std::shared_ptr<IEventLoopGroup> create(const Options& options);
+	static std::shared_ptr<IEventLoopGroup> create();
+
+	virtual uint32_t getNumLoops() const = 0;
+
+	/*! @brief Same as IEventLoop::addFdHandler(), on loop loopIndex or on the one chosen by the balancing policy */
+	virtual ReturnCode addFdHandler(int fd, uint32_t eventMask, IEventLoop::CallbackFunc&& callback, uint32_t loopIndex = AnyLoop) = 0;
+	virtual ReturnCode updateFdEvents(int fd, uint32_t eventMask) = 0;
+	virtual ReturnCode removeFdHandler(int fd) = 0;
+
+	/*! @brief Index of the loop which owns the FD, for example to post() work that must run along with its callback */
+	virtual ReturnCode getLoopIndex(int fd, uint32_t& loopIndex) const = 0;
+
+	/*! @brief Same as IEventLoop::post(), to loop loopIndex or, with AnyLoop, to the loops in turn */
+	virtual ReturnCode post(IEventLoop::EventHandlerFunc&& eventHandler, uint32_t loopIndex = AnyLoop) = 0;
+
+	virtual ~IEventLoopGroup() = default;
+
+	// First prevent end users from copy/move construtors
+	IEventLoopGroup(const IEventLoopGroup&)               = delete;
+	IEventLoopGroup(IEventLoopGroup&&)                    = delete;
+	IEventLoopGroup& operator=(const IEventLoopGroup&)    = delete;
+	IEventLoopGroup& operator=(IEventLoopGroup&&)         = delete;
+
+protected:
+	IEventLoopGroup() = default;
+
+}; // class IEventLoopGroup
+
+} // namespace V1
+
+} // namespace EventLoop
+
+} // namespace UtilsFramework
@@ -10,7 +10,12 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <sys/signalfd.h>
+
+#include "inplaceFunctionIf.h"
 
 namespace UtilsFramework
 {
@@ -77,25 +82,234 @@ public:
 
 	static IEventLoop& getThreadLocalInstance();
 
+	/*! @brief Kernel interface used by the Event Loop to wait for FD readiness */
+	enum class Backend
+	{
+		Epoll,      /*!< epoll_ctl()/epoll_wait(), the default */
+		IoUring     /*!< io_uring poll requests, registration changes are batched into the next wait */
+	};
+
+	/*! @brief Select the backend of this Event Loop. Must be called before the first addFdHandler(), since the kernel
+	* instance is created at that point, otherwise ALREADY_EXISTS is returned. INTERNAL_FAULT is returned if the
+	* running kernel does not support the requested backend, the loop keeps using epoll in that case. */
+	virtual ReturnCode setBackend(Backend backend) = 0;
+
 	/* Supported FD event type. Used in the event mask */
 	static constexpr uint32_t FdEventIn     = 0x001;    /*!< The FD is readable */
 	static constexpr uint32_t FdEventOut    = 0x002;    /*!< The FD is writeable */
+	static constexpr uint32_t FdEventRdHup  = 0x004;    /*!< Stream socket peer closed connection or shut down writing half */
+	static constexpr uint32_t FdEventErr    = 0x008;    /*!< Error condition happened on the FD, reported only if requested */
+	static constexpr uint32_t FdEventHup    = 0x010;    /*!< Hang up happened on the FD, reported only if requested */
+
+	/* Supported registration modes. Only used in the event mask given to addFdHandler() and updateFdEvents(),
+	*  they are never reported back to the callback. Without any of them, FDs are level-triggered. */
+	static constexpr uint32_t FdModeEdgeTriggered   = 0x100;    /*!< Only report readiness changes. The callback must
+	                                                                 read/write until EAGAIN, otherwise it will not be
+	                                                                 called again for the data already pending */
+	static constexpr uint32_t FdModeOneShot         = 0x200;    /*!< Disable the FD after one event, re-enable it with
+	                                                                 rearmFd() once the callback is ready for more */
+	static constexpr uint32_t FdModeExclusive       = 0x400;    /*!< Wake up only one of the event loops watching the same
+	                                                                 FD (e.g. a shared listening socket). Only valid in
+	                                                                 addFdHandler() and only together with FdEventIn,
+	                                                                 FdEventOut, FdEventErr, FdEventHup and
+	                                                                 FdModeEdgeTriggered. Such FDs cannot be updated */
 
-	using CallbackFunc = std::function<void(int fd, uint32_t eventMask)>;
-	virtual ReturnCode addFdHandler(int fd, uint32_t eventMask, const CallbackFunc& callback) = 0;
+	/* Callbacks are stored inline, without any heap allocation, see InplaceFunction. A lambda can be given directly,
+	*  a CallbackFunc variable has to be given with std::move() */
+	using CallbackFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(int fd, uint32_t eventMask)>;
+
+	/*! @brief Priority classes of FD handlers. Each batch returned by epoll_wait() is dispatched class by class, so a
+	* control FD does not wait behind the bulk data FDs of the same batch. Within a class, the kernel order is kept.
+	* As long as every FD is Normal, the batch is dispatched in a single pass as before. */
+	enum class FdPriority : uint8_t
+	{
+		High,
+		Normal,
+		Low     /*!< May be deferred to the next iteration, see setLowPriorityBudget() */
+	};
+	virtual ReturnCode addFdHandler(int fd, uint32_t eventMask, CallbackFunc&& callback, FdPriority priority = FdPriority::Normal) = 0;
+
+	/*! @brief Change the event mask of a FD. The change is recorded and given to the kernel just before the next wait,
+	* together with all other changes of the iteration, and not at all if the mask ends up unchanged, e.g. a handler
+	* which enables and disables FdEventOut around every write. Events of the current batch are already filtered with
+	* the new mask. Since the system call is deferred, a kernel error is only traced, not returned. */
 	virtual ReturnCode updateFdEvents(int fd, uint32_t eventMask) = 0;
 	virtual ReturnCode removeFdHandler(int fd) = 0;
+	/*! @brief Re-enable a FD registered with FdModeOneShot after its event has been dispatched, keeping its event mask.
+	* Deferred like updateFdEvents(). */
+	virtual ReturnCode rearmFd(int fd) = 0;
+
+	/*! @brief FD handler groups, for many similar FDs sharing one callback (e.g. one FD per sensor device). Instead of
+	* one callback per ready FD, the group callback is called once per batch with all FDs of the group which are ready
+	* in that batch, after the other FD callbacks of the batch, so it can process them in one go. The events array is
+	* only valid during the callback. FDs join a group with addFdToGroup(), have the Normal priority and are removed
+	* with removeFdHandler() like any other FD. removeFdGroup() also removes the FDs left in the group. */
+	struct FdEvent
+	{
+		int fd;
+		uint32_t eventMask;
+	};
+	using FdGroupCallbackFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(const FdEvent* events, size_t count)>;
+	virtual ReturnCode addFdGroup(FdGroupCallbackFunc&& callback, uint32_t& groupId) = 0;
+	virtual ReturnCode addFdToGroup(uint32_t groupId, int fd, uint32_t eventMask) = 0;
+	virtual ReturnCode removeFdGroup(uint32_t groupId) = 0;
 	virtual ReturnCode run() = 0;
 	virtual ReturnCode stop()
 	{
 		return ReturnCode::NORMAL;
 	}
 
+	/*! @brief Run a single iteration of the loop, so that it can be pumped from another main loop: execute posted
+	* events, wait at most timeout for FD events (zero only polls, a negative timeout waits infinitely), dispatch them,
+	* then execute scheduled events. dispatched is set to the number of FD callbacks, posted and scheduled events
+	* executed. The wait is skipped if no FD handler is registered or stop() was called by a posted event. */
+	virtual ReturnCode runOnce(std::chrono::nanoseconds timeout, uint32_t& dispatched) = 0;
+
+	/*! @brief Iterate like run() until deadline, stop() or no FD handler is left. The last wait is shortened so that
+	* it never goes past deadline. dispatched is the total over all iterations. */
+	virtual ReturnCode runUntil(std::chrono::steady_clock::time_point deadline, uint32_t& dispatched) = 0;
+
+	ReturnCode runFor(std::chrono::nanoseconds duration, uint32_t& dispatched)
+	{
+		return runUntil(std::chrono::steady_clock::now() + duration, dispatched);
+	}
+
+	/*! @brief Counters describing how well epoll_wait() batches ready events. Can be read from any thread. */
+	struct EpollStatistics
+	{
+		uint64_t epollWaitCalls     = 0;    /*!< Number of epoll_wait() system calls made by run() */
+		uint64_t wakeups            = 0;    /*!< Number of epoll_wait() calls which returned at least one event */
+		uint64_t readyEvents        = 0;    /*!< Total number of events returned by epoll_wait() */
+		uint64_t epollCtlCalls      = 0;    /*!< Number of epoll_ctl() system calls, all operations */
+		uint64_t coalescedUpdates   = 0;    /*!< updateFdEvents()/rearmFd() calls which did not need an epoll_ctl() */
+		double syscallsPerSecond    = 0.0;  /*!< epoll_wait() calls per second since run() was first called */
+		double avgEventsPerWakeup   = 0.0;  /*!< readyEvents / wakeups */
+		uint32_t currentBatchSize   = 0;    /*!< Current capacity of the epoll event buffer */
+		uint64_t scheduledEvents    = 0;    /*!< Number of scheduled events executed */
+		uint64_t scheduledBacklog   = 0;    /*!< Scheduled events left over by the last iteration due to its budget */
+		uint64_t busyPollSpinTimeUs = 0;    /*!< Configured spin time of the busy poll policy, 0 if disabled */
+		uint64_t busyPollHits       = 0;    /*!< Spins which ended with an event before the spin time elapsed */
+		uint64_t busyPollMisses     = 0;    /*!< Spins which elapsed without any event, then fell back to blocking */
+		uint64_t busyPollTimeNs     = 0;    /*!< Total time spent spinning */
+		uint64_t deferredEvents     = 0;    /*!< Low priority events deferred because of the low priority budget */
+	};
+
+	/*! @brief Bound the number of events fetched by a single epoll_wait(). The loop starts at minEvents and doubles
+	* the batch whenever epoll_wait() fills it completely, shrinking back when batches stay mostly empty.
+	* Set minEvents == maxEvents to get a fixed batch size. */
+	virtual ReturnCode setEpollBatchSize(uint32_t minEvents, uint32_t maxEvents) = 0;
+	virtual EpollStatistics getEpollStatistics() const = 0;
+
+	/*! @brief Once dispatching the current batch has taken maxTime, the Low priority events left in it are deferred to
+	* the next iteration, which then polls instead of blocking. Level-triggered FDs are simply reported again by the
+	* kernel, edge-triggered and one-shot events are kept by the loop. 0 means no limit, which is the default. */
+	virtual ReturnCode setLowPriorityBudget(std::chrono::microseconds maxTime) = 0;
+
+	/*! @brief Hybrid busy polling, for latency-critical loops on isolated CPUs. Within spinTime after the last event,
+	* the loop polls with a zero timeout instead of blocking in epoll_wait(), so the next event is picked up without
+	* any scheduler wakeup latency, at the cost of a fully busy CPU. Between two empty polls the CPU pauses minPauses
+	* times, doubling up to maxPauses (backoff). Events posted from other threads are noticed without any eventfd
+	* write while spinning. Once spinTime has elapsed without any event, the loop blocks as usual. */
+	struct BusyPollPolicy
+	{
+		std::chrono::microseconds spinTime {0};     /*!< 0 disables busy polling, which is the default */
+		uint32_t minPauses = 1;                     /*!< 0 polls back to back without pausing */
+		uint32_t maxPauses = 64;
+	};
+	virtual ReturnCode setBusyPollPolicy(const BusyPollPolicy& policy) = 0;
+
+	/*! @brief Summary of one instrumentation histogram. Durations are in nanoseconds. Percentiles are exact up to the
+	* bucket resolution of the histogram (12.5%). */
+	struct HistogramSnapshot
+	{
+		uint64_t count  = 0;
+		uint64_t min    = 0;
+		uint64_t max    = 0;
+		double mean     = 0.0;
+		uint64_t p50    = 0;
+		uint64_t p90    = 0;
+		uint64_t p99    = 0;
+		uint64_t p999   = 0;
+		std::vector<std::pair<uint64_t, uint64_t>> buckets;     /*!< {upper bound, count} of non-empty buckets */
+	};
+
+	struct InstrumentationSnapshot
+	{
+		HistogramSnapshot callbackLatency;      /*!< Execution time of FD callbacks */
+		HistogramSnapshot eventHandlerLatency;  /*!< Execution time of scheduled and posted event handlers */
+		HistogramSnapshot dispatchLag;          /*!< Time from epoll_wait() returning to the start of each FD callback */
+		HistogramSnapshot iterationTime;        /*!< Busy time of each loop iteration, i.e. without waiting */
+		HistogramSnapshot eventsPerBatch;       /*!< Number of events returned by epoll_wait() */
+		uint64_t slowCallbacks = 0;             /*!< Callbacks and event handlers slower than the threshold */
+	};
+
+	/*! @brief Called after a FD callback (fd >= 0) or an event handler (fd == -1) took at least the slow threshold */
+	using SlowCallbackFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(int fd, std::chrono::nanoseconds duration)>;
+
+	/*! @brief Start recording the histograms of InstrumentationSnapshot. Instrumentation is disabled by default, which
+	* only costs one branch per FD callback, event handler and loop iteration. Once enabled, each of them reads the
+	* monotonic clock twice. A slowThreshold of 0 disables the slow-callback detector, otherwise every callback taking
+	* at least slowThreshold is counted and reported to slowCallbackHandler, if given.
+	* ALREADY_EXISTS is returned if instrumentation is already enabled. */
+	virtual ReturnCode enableInstrumentation(std::chrono::nanoseconds slowThreshold, SlowCallbackFunc&& slowCallbackHandler = nullptr) = 0;
+	virtual ReturnCode disableInstrumentation() = 0;
+
+	/*! @brief Copy the histograms recorded since enableInstrumentation(). Like all other calls, it must be done by the
+	* owner thread, other threads can post() a function doing it. NOT_FOUND is returned if instrumentation is disabled. */
+	virtual ReturnCode getInstrumentationSnapshot(InstrumentationSnapshot& snapshot) const = 0;
+
+	/*! @brief Zero-copy relay: everything readable from sourceFd is moved to sinkFd with splice() through an internal
+	* pipe, without ever being copied to user space. Both FDs must be non-blocking and are registered to this Event
+	* Loop by the relay, so they must not have FD handlers of their own. Backpressure is automatic: while the sink
+	* does not take more data, the source stops being polled until the pipe has been drained.
+	* doneHandler is called once the source reached end of file and every byte has been written to the sink (error 0),
+	* or with the errno of a failed splice(), e.g. EPIPE without any SIGPIPE if the reader of the sink is gone. The relay
+	* is already removed at that point, the FDs are not closed. */
+	struct RelayStatistics
+	{
+		uint64_t bytesRelayed   = 0;    /*!< Bytes written to the sink */
+		uint64_t sourceStalls   = 0;    /*!< Times the source was paused because the sink was too slow */
+		uint64_t sinkStalls     = 0;    /*!< Times the sink returned EAGAIN */
+	};
+	using RelayDoneFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(int sourceFd, int error, const RelayStatistics& statistics)>;
+	virtual ReturnCode addRelay(int sourceFd, int sinkFd, RelayDoneFunc&& doneHandler = nullptr) = 0;
+	/*! @brief Stop relaying without calling the doneHandler, data still in the internal pipe is dropped */
+	virtual ReturnCode removeRelay(int sourceFd) = 0;
+	virtual ReturnCode getRelayStatistics(int sourceFd, RelayStatistics& statistics) const = 0;
+
 /****************************************************-SPECIAL-USE-*****************************************************/
 
 	/*! @brief Callback function signature used for handling a own scheduled events. */
-	using EventHandlerFunc = std::function<void()>;
-	virtual ReturnCode scheduleEvent(const EventHandlerFunc& eventHandler) = 0;
+	using EventHandlerFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void()>;
+	virtual ReturnCode scheduleEvent(EventHandlerFunc&& eventHandler) = 0;
+
+	/*! @brief Scheduled events are executed once per loop iteration, after the FD events of that iteration, whether
+	* or not any FD fired. An iteration only executes the events which were scheduled before it started, events
+	* scheduled by an eventHandler run in the next iteration, so rescheduling handlers cannot starve FD dispatching.
+	* This sets how much of that work a single iteration may do: at most maxEvents events and, once maxTime has
+	* elapsed, no further event. The rest is left as backlog for the next iterations, which then do not block in
+	* epoll_wait(). 0 for either of them means no limit, which is the default. */
+	virtual ReturnCode setScheduledEventBudget(uint32_t maxEvents, std::chrono::microseconds maxTime) = 0;
+
+	/*! @brief Same as scheduleEvent() but can be called from any thread, e.g. with a reference to another thread's
+	* Event Loop obtained by that thread via getThreadLocalInstance(). The eventHandler is pushed to a lock-free queue
+	* and executed by the owner thread at the beginning of its next loop iteration. The owner is only woken up
+	* through an internal eventfd if it is blocked waiting for events, so bursts of posts cost one system call at most.
+	* Posted events do not keep run() alive: if no FD handler is left they are executed by the next run().
+	* The Event Loop must outlive all threads posting to it. */
+	virtual ReturnCode post(EventHandlerFunc&& eventHandler) = 0;
+
+	/*! @brief Handle a signal synchronously on this Event Loop instead of in an async signal handler. The signal is
+	* blocked in the calling thread and read from a signalfd shared by all signal handlers of this loop, which is
+	* registered like any other FD, so it coexists with the FDs of TimerManager, ItcPubSub,... and keeps run() alive.
+	* All pending signals are read in batches per wakeup and dispatched in order. Process-directed signals (e.g.
+	* SIGTERM sent by kill) go to any thread which does not block them, so they have to be blocked in every thread,
+	* typically with pthread_sigmask() in main() before other threads are created.
+	* INVALID_ARG is returned for SIGKILL, SIGSTOP and invalid numbers, ALREADY_EXISTS if signo already has a handler.
+	* removeSignalHandler() unblocks the signal again unless it was already blocked before addSignalHandler(). */
+	using SignalHandlerFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(const struct signalfd_siginfo& info)>;
+	virtual ReturnCode addSignalHandler(int signo, SignalHandlerFunc&& signalHandler) = 0;
+	virtual ReturnCode removeSignalHandler(int signo) = 0;
 
 /****************************************************-SPECIAL-USE-*****************************************************/
 
@@ -0,0 +1,83 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "eventLoopIf.h"
+#include "eventLoopGroupIf.h"
+
+namespace UtilsFramework
+{
+namespace EventLoop
+{
+namespace V1
+{
+
+class EventLoopGroupImpl : public IEventLoopGroup
+{
+public:
+	explicit EventLoopGroupImpl(const Options& options);
+	~EventLoopGroupImpl() override;
+
+	// First prevent copy/move construtors
+	EventLoopGroupImpl(const EventLoopGroupImpl&)               = delete;
+	EventLoopGroupImpl(EventLoopGroupImpl&&)                    = delete;
+	EventLoopGroupImpl& operator=(const EventLoopGroupImpl&)    = delete;
+	EventLoopGroupImpl& operator=(EventLoopGroupImpl&&)         = delete;
+
+	bool start();
+
+	uint32_t getNumLoops() const override;
+	ReturnCode addFdHandler(int fd, uint32_t eventMask, IEventLoop::CallbackFunc&& callback, uint32_t loopIndex) override;
+	ReturnCode updateFdEvents(int fd, uint32_t eventMask) override;
+	ReturnCode removeFdHandler(int fd) override;
+	ReturnCode getLoopIndex(int fd, uint32_t& loopIndex) const override;
+	ReturnCode post(IEventLoop::EventHandlerFunc&& eventHandler, uint32_t loopIndex) override;
+
+private:
+	struct Loop
+	{
+		std::thread thread;
+		std::thread::id threadId;
+		IEventLoop* eventLoop = nullptr;    /*!< Thread-local Event Loop of the thread, set once it is running */
+		int keepAliveFd = -1;               /*!< Never readable, only keeps run() alive while no FD is registered */
+		uint32_t fdCount = 0;               /*!< FDs registered through the group, protected by m_mutex */
+	};
+
+	using LoopFunc = UtilsFramework::InplaceFunction::V1::InplaceFunction<ReturnCode()>;
+
+	static void loopThreadMain(Loop& loop, const std::string& name, int cpu, IEventLoop::Backend backend,
+	                           std::promise<bool> started);
+	ReturnCode runOnLoop(uint32_t loopIndex, LoopFunc&& func);
+	uint32_t chooseLoop();
+
+	Options m_options;
+	uint32_t m_numLoops;
+	std::unique_ptr<Loop[]> m_loops;
+
+	/* FD to loop index of every FD registered through the group */
+	mutable std::mutex m_mutex;
+	std::unordered_map<int /* fd */, uint32_t /* loopIndex */> m_fdLoops;
+	uint32_t m_nextFdLoop;
+	std::atomic<uint32_t> m_nextPostLoop;
+
+}; // class EventLoopGroupImpl
+
+} // namespace V1
+
+} // namespace EventLoop
+
+} // namespace UtilsFramework
@@ -9,14 +9,20 @@
 
 #pragma once
 
-#include <unordered_map>
 #include <thread>
 #include <memory>
 #include <vector>
 #include <set>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <signal.h>
 
 #include "eventLoopIf.h"
 #include "eventLoopSyscallWrapper.h"
+#include "mpscQueue.h"
+#include "ringQueue.h"
+#include "logHistogram.h"
 
 namespace UtilsFramework
 {
@@ -31,12 +37,33 @@ public:
 	static EventLoopImpl& getThreadLocalInstance();
 	static void reset();
 
-	ReturnCode addFdHandler(int fd, uint32_t eventMask, const CallbackFunc& callback) override;
+	ReturnCode setBackend(Backend backend) override;
+	ReturnCode addFdHandler(int fd, uint32_t eventMask, CallbackFunc&& callback, FdPriority priority = FdPriority::Normal) override;
 	ReturnCode updateFdEvents(int fd, uint32_t eventMask) override;
 	ReturnCode removeFdHandler(int fd) override;
+	ReturnCode rearmFd(int fd) override;
+	ReturnCode addFdGroup(FdGroupCallbackFunc&& callback, uint32_t& groupId) override;
+	ReturnCode addFdToGroup(uint32_t groupId, int fd, uint32_t eventMask) override;
+	ReturnCode removeFdGroup(uint32_t groupId) override;
 	ReturnCode run() override;
 	ReturnCode stop() override;
-	ReturnCode scheduleEvent(const EventHandlerFunc& eventHandler) override;
+	ReturnCode runOnce(std::chrono::nanoseconds timeout, uint32_t& dispatched) override;
+	ReturnCode runUntil(std::chrono::steady_clock::time_point deadline, uint32_t& dispatched) override;
+	ReturnCode scheduleEvent(EventHandlerFunc&& eventHandler) override;
+	ReturnCode setScheduledEventBudget(uint32_t maxEvents, std::chrono::microseconds maxTime) override;
+	ReturnCode post(EventHandlerFunc&& eventHandler) override;
+	ReturnCode addSignalHandler(int signo, SignalHandlerFunc&& signalHandler) override;
+	ReturnCode removeSignalHandler(int signo) override;
+	ReturnCode addRelay(int sourceFd, int sinkFd, RelayDoneFunc&& doneHandler) override;
+	ReturnCode removeRelay(int sourceFd) override;
+	ReturnCode getRelayStatistics(int sourceFd, RelayStatistics& statistics) const override;
+	ReturnCode setEpollBatchSize(uint32_t minEvents, uint32_t maxEvents) override;
+	EpollStatistics getEpollStatistics() const override;
+	ReturnCode setLowPriorityBudget(std::chrono::microseconds maxTime) override;
+	ReturnCode setBusyPollPolicy(const BusyPollPolicy& policy) override;
+	ReturnCode enableInstrumentation(std::chrono::nanoseconds slowThreshold, SlowCallbackFunc&& slowCallbackHandler) override;
+	ReturnCode disableInstrumentation() override;
+	ReturnCode getInstrumentationSnapshot(InstrumentationSnapshot& snapshot) const override;
 
 	EventLoopImpl();
 	virtual ~EventLoopImpl();
@@ -48,16 +75,46 @@ public:
 	EventLoopImpl& operator=(EventLoopImpl&&)         = delete;
 
 private:
-	void handleEpollEvent(const struct epoll_event& event);
-	void dispatchEvent(const CallbackFunc& callback, int fd, uint32_t eventMask);
-	void executeScheduledEvents();
+	bool createEpollInstance();
+	void startRunning();
+	ReturnCode runIteration(int64_t timeoutNs, uint32_t& dispatched);
+	int waitEvents(int maxEvents, int64_t timeoutNs);
+	void flushFdChanges();
+	uint32_t dispatchBatch(int eventCount);
+	FdPriority getEventPriority(const struct epoll_event& event);
+	bool handleEpollEvent(const struct epoll_event& event);
+	uint32_t dispatchFdGroups();
+	void handleWakeup();
+	uint32_t executePostedEvents();
+	struct FdHandler;
+	FdHandler* findFdHandler(int fd);
+	FdHandler& getFdHandlerSlot(int fd);
+	void dispatchEvent(FdHandler& fdHandler, int fd, uint32_t eventMask);
+	uint32_t executeScheduledEvents();
+	void adaptBatchSize(int eventCount);
+	bool busyPoll(int maxEvents, int64_t waitDeadlineNs, int& eventCount);
+	void handleSignals(int signalFd);
+	struct Relay;
+	void handleRelayEvent(int sourceFd, bool isSinkEvent);
+	void fillRelay(Relay& relay);
+	bool flushRelay(Relay& relay);
+	void closeRelay(std::unordered_map<int, std::unique_ptr<Relay>>::iterator iter);
+	void recordCallbackDuration(UtilsFramework::Common::V1::LogHistogram& histogram, int fd, int64_t startNs);
 
 	/*! @brief Because our local events are:
 	*           + FdEventIn     = 0x001
 	*           + FdEventOut    = 0x002
+	*           + FdEventRdHup  = 0x004
+	*           + FdEventErr    = 0x008
+	*           + FdEventHup    = 0x010
 	* While epol events defined in epoll.h are:
 	*           + EPOLLIN       = 0x001
 	*           + EPOLLOUT      = 0x004
+	*           + EPOLLRDHUP    = 0x2000
+	*           + EPOLLERR      = 0x008
+	*           + EPOLLHUP      = 0x010
+	* And our registration modes FdModeEdgeTriggered, FdModeOneShot and FdModeExclusive map to EPOLLET, EPOLLONESHOT
+	* and EPOLLEXCLUSIVE respectively.
 	* 
 	* So we need to convert between them.
 	*/
@@ -69,18 +126,151 @@ private:
 	std::shared_ptr<EventLoopSyscallWrapper> m_syscallWrapper;
 	bool m_isRunning;
 
+	/* FdHandlers are stored in a table indexed by fd, split in pages so that growing it never moves a handler.
+	*  Each epoll event carries the fd and the generation of its registration, so dispatching is a direct lookup
+	*  and stale events of removed (or removed then re-added) FDs are rejected by comparing generations.
+	*  updateFdEvents() and rearmFd() only change epollEvents and mark the slot dirty, the kernel is updated once per
+	*  iteration by flushFdChanges() and only if the mask differs from kernelEvents, or to re-arm a one-shot FD. */
+	struct FdGroup;
 	struct FdHandler
 	{
-		int fd = -1;
-		uint32_t epollEvents = 0;
+		uint32_t epollEvents = 0;   /*!< 0 means the slot is free */
+		uint32_t kernelEvents = 0;  /*!< Mask last given to epoll_ctl() */
+		uint32_t generation = 0;
+		FdPriority priority = FdPriority::Normal;
+		bool isDirty = false;
+		FdGroup* group = nullptr;   /*!< Set for FDs of a handler group, callback is then empty */
 		CallbackFunc callback;
 	};
 
-	using FdHandlerMap = std::unordered_map<int /* fd */, std::shared_ptr<FdHandler> /* fdHandler* */>;
-	FdHandlerMap m_fdHandlers;
-	FdHandlerMap m_removedFdHandlers;
+	static constexpr size_t FdHandlersPerPage   = 1024;
+	static constexpr uint32_t WakeupGeneration  = 0;    /*!< Reserved for m_wakeupFd, never used by FdHandlers */
+
+	std::vector<std::unique_ptr<FdHandler[]>> m_fdHandlerPages;
+	size_t m_fdHandlerCount;
+	size_t m_prioritizedFdCount;    /*!< FdHandlers which are not FdPriority::Normal */
+	std::vector<int> m_dirtyFds;
+
+	/* FD handler groups, keyed by an id which is never reused. Ready events are collected per group while the batch
+	*  is dispatched, with the generation of their FD, so that FDs removed before the group callback runs are dropped. */
+	struct FdGroup
+	{
+		uint32_t id = 0;
+		size_t fdCount = 0;
+		bool isReady = false;
+		std::vector<FdEvent> readyEvents;
+		std::vector<uint32_t> readyGenerations;
+		FdGroupCallbackFunc callback;
+	};
+	std::unordered_map<uint32_t, std::unique_ptr<FdGroup>> m_fdGroups;
+	std::vector<uint32_t> m_readyFdGroups;
+	uint32_t m_nextFdGroupId;
+
+	/* Low priority events of the current batch, and those of the previous batches which were over the low priority
+	*  budget. Deferred ones are dispatched first by the next iteration. */
+	std::vector<struct epoll_event> m_lowPriorityEvents;
+	std::vector<struct epoll_event> m_deferredEvents;
+	std::chrono::microseconds m_lowPriorityBudget;
+	std::atomic<uint64_t> m_deferredEventCount;
+
+	/* A callback may remove or re-add its own fd, the new callback is parked here until the current one returns */
+	int m_dispatchingFd;
+	bool m_isDispatchingFdChanged;
+	CallbackFunc m_dispatchingFdCallback;
+
+	/* scheduleEvent() pushes to m_scheduledEvents. Each iteration swaps it with m_runningEvents once the previous
+	*  snapshot is done, then executes m_runningEvents within the budget. */
+	UtilsFramework::Common::V1::RingQueue<EventHandlerFunc> m_scheduledEvents;
+	UtilsFramework::Common::V1::RingQueue<EventHandlerFunc> m_runningEvents;
+	uint32_t m_scheduledEventBudget;
+	std::chrono::microseconds m_scheduledTimeBudget;
+
+	/* Default bounds of the adaptive epoll batch. The batch doubles when epoll_wait() fills it up and halves after
+	*  ShrinkAfterUnderfilledBatches consecutive batches used less than a quarter of it. */
+	static constexpr uint32_t DefaultMinBatchSize           = 16;
+	static constexpr uint32_t DefaultMaxBatchSize           = 1024;
+	static constexpr uint32_t ShrinkAfterUnderfilledBatches = 8;
+
+	std::vector<struct epoll_event> m_events;
+	uint32_t m_minBatchSize;
+	uint32_t m_maxBatchSize;
+	uint32_t m_underfilledBatches;
+
+	/* Statistics are only written by the owner thread, but may be read by any thread via getEpollStatistics() */
+	std::atomic<uint32_t> m_batchSize;
+	std::atomic<uint64_t> m_epollWaitCalls;
+	std::atomic<uint64_t> m_wakeups;
+	std::atomic<uint64_t> m_readyEvents;
+	std::atomic<uint64_t> m_epollCtlCalls;
+	std::atomic<uint64_t> m_coalescedUpdates;
+	std::atomic<int64_t> m_firstRunTimeNs;
+	std::atomic<uint64_t> m_scheduledEventCount;
+	std::atomic<uint64_t> m_scheduledBacklog;
+
+	/* Busy polling, the spin window starts at m_lastEventTimeNs which is only updated while busy polling is enabled */
+	BusyPollPolicy m_busyPollPolicy;
+	int64_t m_busyPollSpinNs;
+	int64_t m_lastEventTimeNs;
+	std::atomic<uint64_t> m_busyPollHits;
+	std::atomic<uint64_t> m_busyPollMisses;
+	std::atomic<uint64_t> m_busyPollTimeNs;
+
+	/* Cross-thread post() support: events are pushed lock-free by any thread and m_wakeupFd is only written when the
+	*  loop is (about to be) blocked in epoll_wait() and no other producer has written it yet. */
+	int m_wakeupFd;
+	std::atomic<bool> m_isPolling;
+	std::atomic<bool> m_isWakeupPending;
+	UtilsFramework::Common::V1::MpscQueue<EventHandlerFunc> m_postedEvents;
+
+	/* Posted events executed per iteration at most, so that an event posting again to its own loop cannot starve FD
+	*  callbacks and timers. The wait of an iteration which left posted events is skipped, see runIteration(). */
+	static constexpr uint32_t MaxPostedEventsPerIteration = 1024;
+
+	/* Signals handled through one signalfd, which only exists while at least one signal handler is registered.
+	*  m_signalMask is the set given to signalfd(), m_blockedSignals the part of it which we blocked ourselves. */
+	static constexpr size_t SignalInfoBatch = 16;
+	int m_signalFd;
+	sigset_t m_signalMask;
+	sigset_t m_blockedSignals;
+	std::vector<SignalHandlerFunc> m_signalHandlers;    /*!< Indexed by signal number */
+
+	/* splice() relays, keyed by source FD. The source is paused by making it one-shot, so that a hang up while it is
+	*  paused cannot make epoll_wait() spin, and the sink is one-shot too, only re-armed after an EAGAIN. */
+	struct Relay
+	{
+		int sourceFd = -1;
+		int sinkFd = -1;
+		int pipeFds[2] = {-1, -1};
+		size_t pipeCapacity = 0;
+		size_t bufferedBytes = 0;   /*!< In the pipe, not yet written to the sink */
+		bool isSourcePaused = false;
+		bool isSinkWaiting = false;
+		bool isSourceClosed = false;
+		bool isDone = false;
+		int error = 0;
+		RelayStatistics statistics;
+		RelayDoneFunc doneHandler;
+	};
+	std::unordered_map<int /* source fd */, std::unique_ptr<Relay>> m_relays;
+
+	static constexpr uint32_t RelaySourceEvents     = FdEventIn | FdEventHup | FdEventErr;
+	static constexpr uint32_t RelaySinkEvents       = FdEventOut | FdEventHup | FdEventErr | FdModeOneShot;
+	static constexpr size_t DefaultRelayPipeSize    = 65536;
 
-	std::vector<EventHandlerFunc> m_scheduledEvents;
+	/* Only allocated while instrumentation is enabled, so that a disabled one costs a single nullptr check */
+	struct Instrumentation
+	{
+		UtilsFramework::Common::V1::LogHistogram callbackLatency;
+		UtilsFramework::Common::V1::LogHistogram eventHandlerLatency;
+		UtilsFramework::Common::V1::LogHistogram dispatchLag;
+		UtilsFramework::Common::V1::LogHistogram iterationTime;
+		UtilsFramework::Common::V1::LogHistogram eventsPerBatch;
+		uint64_t slowCallbacks = 0;
+		int64_t slowThresholdNs = 0;
+		SlowCallbackFunc slowCallbackHandler;
+		int64_t wakeupTimeNs = 0;   /*!< When the current epoll_wait() returned */
+	};
+	std::unique_ptr<Instrumentation> m_instrumentation;
     
 }; // class EventLoopImpl
 
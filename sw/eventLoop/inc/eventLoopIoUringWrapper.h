@@ -0,0 +1,94 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <linux/io_uring.h>
+
+#include "eventLoopSyscallWrapper.h"
+
+/*! @brief io_uring backend of the Event Loop. It keeps the epoll_create1/epoll_ctl/epoll_wait contract of
+* EventLoopSyscallWrapper so that EventLoopImpl does not need to know which kernel interface is used:
+* + epoll_create1() sets up a ring and returns its FD, which EventLoopImpl keeps as m_epfd.
+* + epoll_ctl() does not enter the kernel, it only queues IORING_OP_POLL_ADD/IORING_OP_POLL_REMOVE requests.
+* + epoll_wait() returns already completed poll requests without any system call. Otherwise it submits all queued
+*   registration changes and waits for completions in one single io_uring_enter().
+*
+* Edge-triggered FDs use one multishot poll request. Level-triggered FDs use a single-shot poll request which is
+* re-armed right after its event has been returned, the re-arm being submitted with the next wait, so an FD that
+* still has pending data is reported again like with epoll. One-shot FDs are only re-armed by EPOLL_CTL_MOD. */
+class EventLoopIoUringWrapper : public EventLoopSyscallWrapper
+{
+public:
+	EventLoopIoUringWrapper() : EventLoopSyscallWrapper(false)
+	{
+	}
+	~EventLoopIoUringWrapper() override;
+
+	// First prevent copy/move construtors
+	EventLoopIoUringWrapper(const EventLoopIoUringWrapper&)               = delete;
+	EventLoopIoUringWrapper(EventLoopIoUringWrapper&&)                    = delete;
+	EventLoopIoUringWrapper& operator=(const EventLoopIoUringWrapper&)    = delete;
+	EventLoopIoUringWrapper& operator=(EventLoopIoUringWrapper&&)         = delete;
+
+	int epoll_create1(int flags) override;
+	int epoll_ctl(int epfd, int op, int fd, struct epoll_event* event) override;
+	int epoll_wait(int epfd, struct epoll_event* events, int maxEvents, int timeout) override;
+	int epoll_pwait2(int epfd, struct epoll_event* events, int maxEvents, const struct timespec* timeout) override;
+
+private:
+	struct Registration
+	{
+		uint32_t epollEvents = 0;
+		epoll_data_t data;
+		uint32_t generation = 0;    /*!< Completions of older poll requests on the same FD carry another generation */
+		bool isArmed = false;       /*!< A poll request of this generation is queued or in flight */
+	};
+
+	struct io_uring_sqe* getSqe();
+	bool queuePollAdd(int fd, Registration& registration);
+	bool queuePollRemove(int fd, const Registration& registration);
+	int wait(int epfd, struct epoll_event* events, int maxEvents, int64_t timeoutNs);
+	int enter(uint32_t minComplete, int64_t timeoutNs);
+	int reapCompletions(struct epoll_event* events, int maxEvents);
+	void unmapRing();
+
+	static uint64_t makeUserData(int fd, uint32_t generation);
+
+	/* user_data of our own IORING_OP_POLL_REMOVE requests, their completions are always ignored */
+	static constexpr uint64_t PollRemoveUserData   = ~0ULL;
+	static constexpr uint32_t SubmissionQueueSize  = 256;
+	static constexpr uint32_t CompletionQueueSize  = 4096;
+
+	int m_ringFd = -1;
+
+	void* m_sqRingPtr = nullptr;
+	size_t m_sqRingSize = 0;
+	void* m_cqRingPtr = nullptr;
+	size_t m_cqRingSize = 0;
+	struct io_uring_sqe* m_sqes = nullptr;
+	size_t m_sqesSize = 0;
+
+	uint32_t* m_sqHead = nullptr;
+	uint32_t* m_sqTail = nullptr;
+	uint32_t* m_sqArray = nullptr;
+	uint32_t m_sqMask = 0;
+	uint32_t m_sqEntries = 0;
+
+	uint32_t* m_cqHead = nullptr;
+	uint32_t* m_cqTail = nullptr;
+	struct io_uring_cqe* m_cqes = nullptr;
+	uint32_t m_cqMask = 0;
+
+	std::unordered_map<int /* fd */, Registration> m_registrations;
+	uint32_t m_nextGeneration = 1;
+
+}; // class EventLoopIoUringWrapper
@@ -10,14 +10,26 @@
 #pragma once
 
 #include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include <iostream>
 
+#include "threadCheckPolicy.h"
+
 class EventLoopSyscallWrapper
 {
 public:
 	EventLoopSyscallWrapper() = default;
 	virtual ~EventLoopSyscallWrapper() = default;
 
+	/*! @brief False for wrappers which do not forward to the kernel epoll, i.e. the io_uring backend */
+	bool isKernelEpoll() const
+	{
+		return m_isKernelEpoll;
+	}
+
 	// First prevent copy/move construtors
 	EventLoopSyscallWrapper(const EventLoopSyscallWrapper&)               = delete;
 	EventLoopSyscallWrapper(EventLoopSyscallWrapper&&)                    = delete;
@@ -39,4 +51,92 @@ public:
 		return ::epoll_wait(epfd, event, maxEvents, timeout);
 	}
 
-}; // class EventLoopSyscallWrapper
\ No newline at end of file
+	/*! @brief Wait with a nanosecond timeout, nullptr waits infinitely. Kernels older than 5.11 do not have
+	* epoll_pwait2(), the timeout is then rounded up to milliseconds and given to epoll_wait(). */
+	virtual int epoll_pwait2(int epfd, struct epoll_event* event, int maxEvents, const struct timespec* timeout)
+	{
+#ifdef SYS_epoll_pwait2
+		if(m_hasEpollPwait2)
+		{
+			int result = static_cast<int>(::syscall(SYS_epoll_pwait2, epfd, event, maxEvents, timeout, nullptr, 0));
+			if(result != -1 || errno != ENOSYS)
+			{
+				return result;
+			}
+			m_hasEpollPwait2 = false;
+		}
+#endif
+		return epoll_wait(epfd, event, maxEvents, toMilliseconds(timeout));
+	}
+
+protected:
+	explicit EventLoopSyscallWrapper(bool isKernelEpoll) : m_isKernelEpoll(isKernelEpoll)
+	{
+	}
+
+	static int toMilliseconds(const struct timespec* timeout)
+	{
+		if(timeout == nullptr)
+		{
+			return -1;
+		}
+
+		long long milliseconds = static_cast<long long>(timeout->tv_sec) * 1000 + (timeout->tv_nsec + 999999) / 1000000;
+		return milliseconds > 0x7FFFFFFF ? 0x7FFFFFFF : static_cast<int>(milliseconds);
+	}
+
+private:
+	bool m_isKernelEpoll = true;
+	bool m_hasEpollPwait2 = true;
+
+}; // class EventLoopSyscallWrapper
+
+/* How EventLoopImpl makes its system calls, selected by UF_DIRECT_SYSCALLS (see threadCheckPolicy.h):
+* + WrappedEventLoopSyscalls: always through the virtual functions of the wrapper, so that unit tests can mock them.
+* + DirectEventLoopSyscalls: with the default epoll backend, the non-virtual base functions are called, which the
+*   compiler inlines to the plain system calls. The io_uring backend still goes through its overrides. Mocks derived
+*   from EventLoopSyscallWrapper are bypassed, so such builds cannot use them. */
+struct WrappedEventLoopSyscalls
+{
+	static int epoll_ctl(EventLoopSyscallWrapper& wrapper, int epfd, int op, int fd, struct epoll_event* event)
+	{
+		return wrapper.epoll_ctl(epfd, op, fd, event);
+	}
+
+	static int epoll_wait(EventLoopSyscallWrapper& wrapper, int epfd, struct epoll_event* event, int maxEvents, int timeout)
+	{
+		return wrapper.epoll_wait(epfd, event, maxEvents, timeout);
+	}
+
+	static int epoll_pwait2(EventLoopSyscallWrapper& wrapper, int epfd, struct epoll_event* event, int maxEvents, const struct timespec* timeout)
+	{
+		return wrapper.epoll_pwait2(epfd, event, maxEvents, timeout);
+	}
+};
+
+struct DirectEventLoopSyscalls
+{
+	static int epoll_ctl(EventLoopSyscallWrapper& wrapper, int epfd, int op, int fd, struct epoll_event* event)
+	{
+		return wrapper.isKernelEpoll() ? wrapper.EventLoopSyscallWrapper::epoll_ctl(epfd, op, fd, event) :
+			wrapper.epoll_ctl(epfd, op, fd, event);
+	}
+
+	static int epoll_wait(EventLoopSyscallWrapper& wrapper, int epfd, struct epoll_event* event, int maxEvents, int timeout)
+	{
+		return wrapper.isKernelEpoll() ? wrapper.EventLoopSyscallWrapper::epoll_wait(epfd, event, maxEvents, timeout) :
+			wrapper.epoll_wait(epfd, event, maxEvents, timeout);
+	}
+
+	static int epoll_pwait2(EventLoopSyscallWrapper& wrapper, int epfd, struct epoll_event* event, int maxEvents, const struct timespec* timeout)
+	{
+		return wrapper.isKernelEpoll() ? wrapper.EventLoopSyscallWrapper::epoll_pwait2(epfd, event, maxEvents, timeout) :
+			wrapper.epoll_pwait2(epfd, event, maxEvents, timeout);
+	}
+};
+
+#if UF_DIRECT_SYSCALLS
+using EventLoopSyscalls = DirectEventLoopSyscalls;
+#else
+using EventLoopSyscalls = WrappedEventLoopSyscalls;
+#endif
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+#include <vector>
+
+#include "util_framework_trace.h"
+#include "eventLoopGroupImpl.h"
+
+using namespace CommonUtils::V1::StringUtils;
+
+namespace UtilsFramework
+{
+namespace EventLoop
+{
+namespace V1
+{
+
+std::shared_ptr<IEventLoopGroup> IEventLoopGroup::create()
+{
+	return create(Options());
+}
+
+std::shared_ptr<IEventLoopGroup> IEventLoopGroup::create(const Options& options)
+{
+	auto group = std::make_shared<EventLoopGroupImpl>(options);
+	if(!group->start())
+	{
+		group.reset(); // Reset shared_ptr to nullptr
+	}
+
+	return group;
+}
+
+EventLoopGroupImpl::EventLoopGroupImpl(const Options& options)
+	: m_options(options),
+	  m_numLoops(0),
+	  m_nextFdLoop(0),
+	  m_nextPostLoop(0)
+{
+}
+
+EventLoopGroupImpl::~EventLoopGroupImpl()
+{
+	for(uint32_t i = 0; i < m_numLoops; ++i)
+	{
+		Loop& loop = m_loops[i];
+		if(loop.eventLoop != nullptr)
+		{
+			// Remove the FDs still registered on this loop, then let its run() return
+			std::vector<int> fds;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for(const auto& fdLoop : m_fdLoops)
+				{
+					if(fdLoop.second == i)
+					{
+						fds.push_back(fdLoop.first);
+					}
+				}
+			}
+
+			int keepAliveFd = loop.keepAliveFd;
+			LoopFunc stopFunc = [fds = std::move(fds), keepAliveFd]() -> ReturnCode
+			{
+				IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+				for(int fd : fds)
+				{
+					(void)eventLoop.removeFdHandler(fd);
+				}
+				(void)eventLoop.removeFdHandler(keepAliveFd);
+				return eventLoop.stop();
+			};
+
+			if(loop.threadId == std::this_thread::get_id())
+			{
+				/* The group is destroyed by one of its own loops -> stop that loop and let its thread end by itself */
+				(void)stopFunc();
+				loop.thread.detach();
+				continue;
+			}
+
+			(void)loop.eventLoop->post([&stopFunc]() { (void)stopFunc(); });
+			loop.thread.join();
+		}
+
+		if(loop.thread.joinable())
+		{
+			loop.thread.join();
+		}
+	}
+}
+
+bool EventLoopGroupImpl::start()
+{
+	m_numLoops = m_options.numLoops;
+	if(m_numLoops == 0)
+	{
+		m_numLoops = m_options.cpus.empty() ? std::thread::hardware_concurrency() : m_options.cpus.size();
+	}
+	if(m_numLoops == 0)
+	{
+		m_numLoops = 1;
+	}
+
+	m_loops.reset(new Loop[m_numLoops]);
+	for(uint32_t i = 0; i < m_numLoops; ++i)
+	{
+		int cpu = m_options.cpus.empty() ? -1 : m_options.cpus[i % m_options.cpus.size()];
+		std::string name = m_options.name + "-" + std::to_string(i);
+
+		// Each thread reports whether its loop is up and running, so that post() can be used right after create()
+		std::promise<bool> started;
+		std::future<bool> isStarted = started.get_future();
+		m_loops[i].thread = std::thread(&EventLoopGroupImpl::loopThreadMain, std::ref(m_loops[i]), name, cpu, m_options.backend, std::move(started));
+		if(!isStarted.get())
+		{
+			UF_TRACE(TRACE_ERROR, "start - Failed to start loop ", i, " of ", m_options.name, ", cpu = ", cpu);
+			return false;
+		}
+	}
+
+	UF_TRACE(TRACE_INFO, "start - Started ", m_numLoops, " loops of ", m_options.name);
+	return true;
+}
+
+void EventLoopGroupImpl::loopThreadMain(Loop& loop, const std::string& name, int cpu, IEventLoop::Backend backend,
+                                        std::promise<bool> started)
+{
+	prctl(PR_SET_NAME, name.c_str(), 0, 0, 0);
+
+	if(cpu >= 0)
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(cpu, &cpuSet);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+		{
+			started.set_value(false);
+			return;
+		}
+	}
+
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	if(backend != IEventLoop::Backend::Epoll && eventLoop.setBackend(backend) != IEventLoop::ReturnCode::NORMAL)
+	{
+		started.set_value(false);
+		return;
+	}
+
+	int keepAliveFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(keepAliveFd == -1 || eventLoop.addFdHandler(keepAliveFd, IEventLoop::FdEventIn, [](int, uint32_t) {}) != IEventLoop::ReturnCode::NORMAL)
+	{
+		if(keepAliveFd != -1)
+		{
+			close(keepAliveFd);
+		}
+		started.set_value(false);
+		return;
+	}
+
+	loop.threadId = std::this_thread::get_id();
+	loop.eventLoop = &eventLoop;
+	loop.keepAliveFd = keepAliveFd;
+	started.set_value(true);
+
+	// From here on, loop may be destroyed as soon as run() returns, see ~EventLoopGroupImpl()
+	(void)eventLoop.run();
+	close(keepAliveFd);
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::runOnLoop(uint32_t loopIndex, LoopFunc&& func)
+{
+	Loop& loop = m_loops[loopIndex];
+	if(loop.threadId == std::this_thread::get_id())
+	{
+		return func();
+	}
+
+	std::promise<ReturnCode> result;
+	std::future<ReturnCode> futureResult = result.get_future();
+	ReturnCode rc = loop.eventLoop->post([&func, &result]()
+	{
+		result.set_value(func());
+	});
+	if(rc != ReturnCode::NORMAL)
+	{
+		return rc;
+	}
+
+	return futureResult.get();
+}
+
+uint32_t EventLoopGroupImpl::chooseLoop()
+{
+	if(m_options.balancingPolicy == BalancingPolicy::RoundRobin)
+	{
+		return m_nextFdLoop++ % m_numLoops;
+	}
+
+	uint32_t leastLoaded = 0;
+	for(uint32_t i = 1; i < m_numLoops; ++i)
+	{
+		if(m_loops[i].fdCount < m_loops[leastLoaded].fdCount)
+		{
+			leastLoaded = i;
+		}
+	}
+
+	return leastLoaded;
+}
+
+uint32_t EventLoopGroupImpl::getNumLoops() const
+{
+	return m_numLoops;
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::addFdHandler(int fd, uint32_t eventMask, IEventLoop::CallbackFunc&& callback, uint32_t loopIndex)
+{
+	if(loopIndex != AnyLoop && loopIndex >= m_numLoops)
+	{
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Invalid loop index ", loopIndex, " for FD ", fd, "!");
+		return ReturnCode::INVALID_ARG;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_fdLoops.find(fd) != m_fdLoops.end())
+		{
+			UF_TRACE(TRACE_ABN, "addFdHandler - FD ", fd, " handler already exists!");
+			return ReturnCode::ALREADY_EXISTS;
+		}
+
+		// Reserve the FD right away, so that concurrent callers see it and least-loaded counts it
+		if(loopIndex == AnyLoop)
+		{
+			loopIndex = chooseLoop();
+		}
+		m_fdLoops.emplace(fd, loopIndex);
+		++m_loops[loopIndex].fdCount;
+	}
+
+	ReturnCode rc = runOnLoop(loopIndex, [fd, eventMask, &callback]() -> ReturnCode
+	{
+		return IEventLoop::getThreadLocalInstance().addFdHandler(fd, eventMask, std::move(callback));
+	});
+
+	if(rc != ReturnCode::NORMAL)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fdLoops.erase(fd);
+		--m_loops[loopIndex].fdCount;
+		return rc;
+	}
+
+	UF_TRACE(TRACE_INFO, "addFdHandler - Added FD ", fd, " to loop ", loopIndex);
+	return ReturnCode::NORMAL;
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::updateFdEvents(int fd, uint32_t eventMask)
+{
+	uint32_t loopIndex;
+	ReturnCode rc = getLoopIndex(fd, loopIndex);
+	if(rc != ReturnCode::NORMAL)
+	{
+		return rc;
+	}
+
+	return runOnLoop(loopIndex, [fd, eventMask]() -> ReturnCode
+	{
+		return IEventLoop::getThreadLocalInstance().updateFdEvents(fd, eventMask);
+	});
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::removeFdHandler(int fd)
+{
+	uint32_t loopIndex;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto fd_it = m_fdLoops.find(fd);
+		if(fd_it == m_fdLoops.end())
+		{
+			UF_TRACE(TRACE_ERROR, "removeFdHandler - FD ", fd, " not found!");
+			return ReturnCode::NOT_FOUND;
+		}
+
+		loopIndex = fd_it->second;
+		m_fdLoops.erase(fd_it);
+		--m_loops[loopIndex].fdCount;
+	}
+
+	return runOnLoop(loopIndex, [fd]() -> ReturnCode
+	{
+		return IEventLoop::getThreadLocalInstance().removeFdHandler(fd);
+	});
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::getLoopIndex(int fd, uint32_t& loopIndex) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto fd_it = m_fdLoops.find(fd);
+	if(fd_it == m_fdLoops.end())
+	{
+		return ReturnCode::NOT_FOUND;
+	}
+
+	loopIndex = fd_it->second;
+	return ReturnCode::NORMAL;
+}
+
+IEventLoopGroup::ReturnCode EventLoopGroupImpl::post(IEventLoop::EventHandlerFunc&& eventHandler, uint32_t loopIndex)
+{
+	if(loopIndex == AnyLoop)
+	{
+		loopIndex = m_nextPostLoop.fetch_add(1, std::memory_order_relaxed) % m_numLoops;
+	} else if(loopIndex >= m_numLoops)
+	{
+		UF_TRACE(TRACE_ERROR, "post - Invalid loop index ", loopIndex, "!");
+		return ReturnCode::INVALID_ARG;
+	}
+
+	return m_loops[loopIndex].eventLoop->post(std::move(eventHandler));
+}
+
+} // namespace V1
+
+} // namespace EventLoop
+
+} // namespace UtilsFramework
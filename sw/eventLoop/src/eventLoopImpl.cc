@@ -1,16 +1,124 @@
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstdint>
+#include <time.h>
+#include <sys/eventfd.h>
 
-#include <stringUtils.h>
-#include <traceIf.h>
-
-#include "util_framework_tpt_provider.h"
+#include "util_framework_trace.h"
 #include "threadLocalIf.h"
 #include "eventLoopIf.h"
 #include "eventLoopImpl.h"
+#include "eventLoopIoUringWrapper.h"
 
 using namespace UtilsFramework::ThreadLocal::V1;
 using namespace CommonUtils::V1::StringUtils;
+using namespace UtilsFramework::Common::V1;
+
+// Same as static function in C, all functions in this anonymous namespace are private and have only this-file scope.
+namespace
+{
+
+/* Statistics counters have a single writer (the owner thread), so a relaxed load + store is enough and avoids
+*  a locked read-modify-write instruction on the hot path. */
+template <typename T>
+inline void increaseCounter(std::atomic<T>& counter, T value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/* FD number and registration generation are packed into epoll_data.u64 */
+inline uint64_t makeEpollData(int fd, uint32_t generation)
+{
+	return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+int64_t steadyNowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#else
+	asm volatile("" ::: "memory");
+#endif
+}
+
+void fillHistogramSnapshot(const LogHistogram& histogram, UtilsFramework::EventLoop::V1::IEventLoop::HistogramSnapshot& snapshot)
+{
+	snapshot.count = histogram.count();
+	snapshot.min = histogram.min();
+	snapshot.max = histogram.max();
+	snapshot.mean = histogram.count() ? static_cast<double>(histogram.sum()) / static_cast<double>(histogram.count()) : 0.0;
+	snapshot.p50 = histogram.valueAtPercentile(50.0);
+	snapshot.p90 = histogram.valueAtPercentile(90.0);
+	snapshot.p99 = histogram.valueAtPercentile(99.0);
+	snapshot.p999 = histogram.valueAtPercentile(99.9);
+	snapshot.buckets.clear();
+	histogram.forEachBucket([&snapshot](uint64_t upperBound, uint64_t count)
+	{
+		snapshot.buckets.emplace_back(upperBound, count);
+	});
+}
+
+/* Writing to a socket or pipe whose reader is gone raises SIGPIPE, which terminates the process by default. Keeps it
+*  blocked in this thread for the guard's lifetime, drain() then takes back the one raised by a write failing with
+*  EPIPE, so that only the errno is seen. A SIGPIPE already pending before is left alone. */
+class SigPipeGuard
+{
+public:
+	SigPipeGuard()
+	{
+		sigemptyset(&m_sigPipeSet);
+		sigaddset(&m_sigPipeSet, SIGPIPE);
+		m_isBlocked = pthread_sigmask(SIG_BLOCK, &m_sigPipeSet, &m_previousSet) == 0;
+		m_wasBlocked = m_isBlocked && sigismember(&m_previousSet, SIGPIPE) == 1;
+
+		// Only a thread already blocking SIGPIPE can have one pending
+		sigset_t pendingSet;
+		m_wasPending = m_wasBlocked && sigpending(&pendingSet) == 0 && sigismember(&pendingSet, SIGPIPE) == 1;
+	}
+
+	~SigPipeGuard()
+	{
+		if(m_isBlocked && !m_wasBlocked)
+		{
+			pthread_sigmask(SIG_SETMASK, &m_previousSet, nullptr);
+		}
+	}
+
+	// First prevent copy/move construtors
+	SigPipeGuard(const SigPipeGuard&)               = delete;
+	SigPipeGuard(SigPipeGuard&&)                    = delete;
+	SigPipeGuard& operator=(const SigPipeGuard&)    = delete;
+	SigPipeGuard& operator=(SigPipeGuard&&)         = delete;
+
+	void drain()
+	{
+		if(m_isBlocked && !m_wasPending)
+		{
+			struct timespec noWait = {0, 0};
+			int savedErrno = errno;
+			(void)sigtimedwait(&m_sigPipeSet, nullptr, &noWait);
+			errno = savedErrno;
+		}
+	}
+
+private:
+	sigset_t m_sigPipeSet;
+	sigset_t m_previousSet;
+	bool m_isBlocked;
+	bool m_wasBlocked;
+	bool m_wasPending;
+};
+
+}
 
 namespace UtilsFramework
 {
@@ -31,7 +139,7 @@ EventLoopImpl& EventLoopImpl::getThreadLocalInstance()
 
 void EventLoopImpl::reset()
 {
-	TPT_TRACE(TRACE_INFO, SSTR("Resetting Event Loop..."));
+	UF_TRACE(TRACE_INFO, "Resetting Event Loop...");
     	IThreadLocal<EventLoopImpl>::reset();
 }
 
@@ -39,34 +147,171 @@ EventLoopImpl::EventLoopImpl() :
 	m_epfd(-1),
         m_threadId(std::this_thread::get_id()),
         m_syscallWrapper(std::make_shared<EventLoopSyscallWrapper>()),
-        m_isRunning(false)
+        m_isRunning(false),
+        m_fdHandlerCount(0),
+        m_prioritizedFdCount(0),
+        m_nextFdGroupId(1),
+        m_lowPriorityBudget(0),
+        m_deferredEventCount(0),
+        m_dispatchingFd(-1),
+        m_isDispatchingFdChanged(false),
+        m_scheduledEventBudget(0),
+        m_scheduledTimeBudget(0),
+        m_minBatchSize(DefaultMinBatchSize),
+        m_maxBatchSize(DefaultMaxBatchSize),
+        m_underfilledBatches(0),
+        m_batchSize(DefaultMinBatchSize),
+        m_epollWaitCalls(0),
+        m_wakeups(0),
+        m_readyEvents(0),
+        m_epollCtlCalls(0),
+        m_coalescedUpdates(0),
+        m_firstRunTimeNs(0),
+        m_scheduledEventCount(0),
+        m_scheduledBacklog(0),
+        m_busyPollSpinNs(0),
+        m_lastEventTimeNs(0),
+        m_busyPollHits(0),
+        m_busyPollMisses(0),
+        m_busyPollTimeNs(0),
+        m_wakeupFd(-1),
+        m_isPolling(false),
+        m_isWakeupPending(false),
+        m_signalFd(-1)
 {
+	sigemptyset(&m_signalMask);
+	sigemptyset(&m_blockedSignals);
+
+	// Created up front since post() may be called by other threads at any time
+	m_wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(m_wakeupFd == -1)
+	{
+		UF_TRACE(TRACE_ERROR, "EventLoopImpl - Failed to create wakeup eventfd, errno = ", errno);
+	}
 }
 
 EventLoopImpl::~EventLoopImpl()
 {
-	TPT_TRACE(TRACE_INFO, SSTR("~EventLoopImpl is called!"));
+	UF_TRACE(TRACE_INFO, "~EventLoopImpl is called!");
 	if(m_epfd != -1)
 	{
-		TPT_TRACE(TRACE_INFO, SSTR("~EventLoopImpl - close m_epfd!"));
+		UF_TRACE(TRACE_INFO, "~EventLoopImpl - close m_epfd!");
 		close(m_epfd);
 	}
+
+	if(m_wakeupFd != -1)
+	{
+		close(m_wakeupFd);
+	}
+
+	for(auto& relay : m_relays)
+	{
+		close(relay.second->pipeFds[0]);
+		close(relay.second->pipeFds[1]);
+	}
+
+	if(m_signalFd != -1)
+	{
+		close(m_signalFd);
+		if(m_threadId == std::this_thread::get_id())
+		{
+			pthread_sigmask(SIG_UNBLOCK, &m_blockedSignals, nullptr);
+		}
+	}
+}
+
+bool EventLoopImpl::createEpollInstance()
+{
+	// Use EPOLL_CLOEXEC flag to avoid potential race condition in multithreaded application
+	int epfd = m_syscallWrapper->epoll_create1(EPOLL_CLOEXEC);
+	if(-1 == epfd)
+	{
+		UF_TRACE(TRACE_ERROR, "createEpollInstance - Failed to epoll_create(), errno = ", errno);
+		return false;
+	}
+
+	// The wakeup eventfd is registered with the reserved WakeupGeneration. It has no FdHandler,
+	// so it does not keep run() alive on its own.
+	if(m_wakeupFd != -1)
+	{
+		struct epoll_event epEvent;
+		memset(&epEvent, 0, sizeof(struct epoll_event));
+		epEvent.events = EPOLLIN;
+		epEvent.data.u64 = makeEpollData(m_wakeupFd, WakeupGeneration);
+		if(EventLoopSyscalls::epoll_ctl(*m_syscallWrapper, epfd, EPOLL_CTL_ADD, m_wakeupFd, &epEvent) == -1)
+		{
+			UF_TRACE(TRACE_ERROR, "createEpollInstance - Failed to add wakeup eventfd, errno = ", errno);
+			close(epfd);
+			return false;
+		}
+	}
+
+	m_epfd = epfd;
+	return true;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::setBackend(Backend backend)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "setBackend - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(m_epfd != -1)
+	{
+		UF_TRACE(TRACE_ABN, "setBackend - Backend can only be selected before the first FD is added!");
+		return IEventLoop::ReturnCode::ALREADY_EXISTS;
+	}
+
+	std::shared_ptr<EventLoopSyscallWrapper> syscallWrapper;
+	if(backend == Backend::IoUring)
+	{
+		syscallWrapper = std::make_shared<EventLoopIoUringWrapper>();
+	} else
+	{
+		syscallWrapper = std::make_shared<EventLoopSyscallWrapper>();
+	}
+
+	// Create the kernel instance right away, so that an unsupported backend is reported here and not by addFdHandler()
+	std::swap(m_syscallWrapper, syscallWrapper);
+	if(!createEpollInstance())
+	{
+		std::swap(m_syscallWrapper, syscallWrapper);
+		UF_TRACE(TRACE_ERROR, "setBackend - Failed to create backend ", static_cast<int>(backend));
+		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+	}
+
+	UF_TRACE(TRACE_INFO, "setBackend - Using backend ", static_cast<int>(backend));
+	return IEventLoop::ReturnCode::NORMAL;
 }
 
-IEventLoop::ReturnCode EventLoopImpl::addFdHandler(int fd, uint32_t eventMask, const CallbackFunc& callback)
+IEventLoop::ReturnCode EventLoopImpl::addFdHandler(int fd, uint32_t eventMask, CallbackFunc&& callback, FdPriority priority)
 {
 	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("addFdHandler - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Not a thread local!");
 		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
-	// Find in the map the respective fd
-	auto fd_it = m_fdHandlers.find(fd);
-	if(fd_it != m_fdHandlers.end())
+	if(fd < 0)
+	{
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Invalid FD ", fd, "!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	if(priority != FdPriority::High && priority != FdPriority::Normal && priority != FdPriority::Low)
+	{
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Invalid priority ", static_cast<int>(priority), " for FD ", fd, "!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	// Find in the table the respective fd
+	if(findFdHandler(fd) != nullptr)
 	{
-		TPT_TRACE(TRACE_ABN, SSTR("addFdHandler - FD ", fd_it->first, " handler already exists!"));
+		UF_TRACE(TRACE_ABN, "addFdHandler - FD ", fd, " handler already exists!");
 		return IEventLoop::ReturnCode::ALREADY_EXISTS;
 	}
 
@@ -74,34 +319,35 @@ IEventLoop::ReturnCode EventLoopImpl::addFdHandler(int fd, uint32_t eventMask, c
 	uint32_t epollEvents = convertToEpollEvents(eventMask);
 	if(0 == epollEvents)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("addFdHandler - Failed to convertToEpollEvents()!"));
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Failed to convertToEpollEvents()!");
 		return IEventLoop::ReturnCode::INVALID_ARG;
 	}
 
 	// If epoll FD instance hasn't been created, create it
 	if(-1 == m_epfd)
 	{
-		// Use EPOLL_CLOEXEC flag to avoid potential race condition in multithreaded application
-		TPT_TRACE(TRACE_INFO, SSTR("addFdHandler - m_epfd hasn't been created yet, create it!"));
-		m_epfd = m_syscallWrapper->epoll_create1(EPOLL_CLOEXEC);
-		if(-1 == m_epfd)
+		UF_TRACE(TRACE_INFO, "addFdHandler - m_epfd hasn't been created yet, create it!");
+		if(!createEpollInstance())
 		{
-			TPT_TRACE(TRACE_ERROR, SSTR("addFdHandler - Failed to epoll_create() m_epfd!"));
-		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+			UF_TRACE(TRACE_ERROR, "addFdHandler - Failed to epoll_create() m_epfd!");
+			return IEventLoop::ReturnCode::INTERNAL_FAULT;
 		}
 	}
 
-	// If everything ok, create a pointer to a FdHandler object
-	auto fdHandler = std::make_shared<FdHandler>();
-	fdHandler->fd = fd;
-	fdHandler->epollEvents = epollEvents;
-	fdHandler->callback = callback;
+	// If everything ok, take the FdHandler slot of this fd. A new generation makes sure that events still pending
+	// for a previous registration of the same fd number will not be dispatched to this one.
+	FdHandler& fdHandler = getFdHandlerSlot(fd);
+	uint32_t generation = fdHandler.generation + 1;
+	if(generation == WakeupGeneration)
+	{
+		++generation;
+	}
 
 	// Then create a standard struct epoll_event used by epoll
 	/*  Definition from <sys/epoll.h>
 	*   struct epoll_event {
 	*       uint32_t        events; // Epoll events
-	*       epoll_data_t    data;   // User data variable, here is our FdHandler objects
+	*       epoll_data_t    data;   // User data variable, here is our fd and its generation
 	*   };
 	* 
 	*   union epoll_data {
@@ -116,36 +362,56 @@ IEventLoop::ReturnCode EventLoopImpl::addFdHandler(int fd, uint32_t eventMask, c
 	struct epoll_event epEvent;
 	memset(&epEvent, 0, sizeof(struct epoll_event));
 	epEvent.events = epollEvents;
-	epEvent.data.ptr = fdHandler.get();
+	epEvent.data.u64 = makeEpollData(fd, generation);
 
 	// Add a FD to the interest list of epoll instance which is referred by m_epfd
-	if(m_syscallWrapper->epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &epEvent) == -1)
+	increaseCounter<uint64_t>(m_epollCtlCalls, 1);
+	if(EventLoopSyscalls::epoll_ctl(*m_syscallWrapper, m_epfd, EPOLL_CTL_ADD, fd, &epEvent) == -1)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("addFdHandler - Failed to epoll_ctl() with EPOLL_CTL_ADD for FD ", fd));
+		UF_TRACE(TRACE_ERROR, "addFdHandler - Failed to epoll_ctl() with EPOLL_CTL_ADD for FD ", fd);
 		return IEventLoop::ReturnCode::INTERNAL_FAULT;
 	}
 
-	// Also add to our map for self management
-	m_fdHandlers.emplace(fd, fdHandler);
+	// Also fill in our table for self management
+	fdHandler.epollEvents = epollEvents;
+	fdHandler.kernelEvents = epollEvents;
+	fdHandler.isDirty = false;
+	fdHandler.generation = generation;
+	fdHandler.priority = priority;
+	fdHandler.group = nullptr;
+	if(fd == m_dispatchingFd)
+	{
+		// The callback being executed right now belongs to this slot, it must not be destroyed before it returns
+		m_dispatchingFdCallback = std::move(callback);
+		m_isDispatchingFdChanged = true;
+	} else
+	{
+		fdHandler.callback = std::move(callback);
+	}
+	++m_fdHandlerCount;
+	if(priority != FdPriority::Normal)
+	{
+		++m_prioritizedFdCount;
+	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("addFdHandler - Added FD ", fd, " handler successfully!"));
+	UF_TRACE(TRACE_INFO, "addFdHandler - Added FD ", fd, " handler successfully!");
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
 IEventLoop::ReturnCode EventLoopImpl::updateFdEvents(int fd, uint32_t eventMask)
 {
 	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("updateFdEvents - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "updateFdEvents - Not a thread local!");
 		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
-	// Find in the map the respective fd
-	auto fd_it = m_fdHandlers.find(fd);
-	if(fd_it == m_fdHandlers.end())
+	// Find in the table the respective fd
+	FdHandler* fdHandler = findFdHandler(fd);
+	if(fdHandler == nullptr)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("updateFdEvents - FD ", fd, " not found!"));
+		UF_TRACE(TRACE_ERROR, "updateFdEvents - FD ", fd, " not found!");
 		return IEventLoop::ReturnCode::NOT_FOUND;
 	}
 
@@ -153,205 +419,1649 @@ IEventLoop::ReturnCode EventLoopImpl::updateFdEvents(int fd, uint32_t eventMask)
 	uint32_t epollEvents = convertToEpollEvents(eventMask);
 	if(0 == epollEvents)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("updateFdEvents - Failed to convertToEpollEvents()!"));
+		UF_TRACE(TRACE_ERROR, "updateFdEvents - Failed to convertToEpollEvents()!");
 		return IEventLoop::ReturnCode::INVALID_ARG;
 	}
 
-	// Create an epoll event struct to ask epoll instance for eventMask changes on respective FD in the interest list.
-	struct epoll_event epEvent;
-	memset(&epEvent, 0, sizeof(struct epoll_event));
-	epEvent.events = epollEvents;
-	fd_it->second->epollEvents = epollEvents;
-	epEvent.data.ptr = fd_it->second.get();
-	if(m_syscallWrapper->epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &epEvent) == -1)
+	// EPOLL_CTL_MOD is refused by the kernel for FDs added with EPOLLEXCLUSIVE
+	if((epollEvents | fdHandler->epollEvents) & EPOLLEXCLUSIVE)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("updateFdEvents - Failed to epoll_ctl() with EPOLL_CTL_MOD for FD ", fd));
-		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+		UF_TRACE(TRACE_ERROR, "updateFdEvents - FD ", fd, " cannot be updated in exclusive mode!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	// Only recorded here, flushFdChanges() asks the epoll instance for the final mask of this iteration
+	fdHandler->epollEvents = epollEvents;
+	if(fdHandler->isDirty)
+	{
+		increaseCounter<uint64_t>(m_coalescedUpdates, 1);
+	} else
+	{
+		fdHandler->isDirty = true;
+		m_dirtyFds.push_back(fd);
 	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("updateFdEvents - Modified FD ", fd, " handler successfully!"));
+	UF_TRACE(TRACE_INFO, "updateFdEvents - Modified FD ", fd, " handler successfully!");
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
-IEventLoop::ReturnCode EventLoopImpl::removeFdHandler(int fd)
+IEventLoop::ReturnCode EventLoopImpl::rearmFd(int fd)
 {
 	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("removeFdHandler - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "rearmFd - Not a thread local!");
 		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
-	// Find in the map the respective fd
-	auto fd_it = m_fdHandlers.find(fd);
-	if(fd_it == m_fdHandlers.end())
+	// Find in the table the respective fd
+	FdHandler* fdHandler = findFdHandler(fd);
+	if(fdHandler == nullptr)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("removeFdHandler - FD ", fd, " not found!"));
+		UF_TRACE(TRACE_ERROR, "rearmFd - FD ", fd, " not found!");
 		return IEventLoop::ReturnCode::NOT_FOUND;
 	}
 
-	// Request epoll instance to delete the fd from the interest list.
-	(void) m_syscallWrapper->epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr);
-
-	/*  Sometime, there could a not yet handled event for the removed FD in current batch
-	*   Therefore, we will temporarily keep the corresponding FdHandler shared_ptr "alive" in our m_removedFdHandlers
-	*   until all events in current batch have been carried out.
-	*   But anyway, we set the event mask to 0 to avoid those event's callbacks being really executed.
-	*/
-	fd_it->second->epollEvents = 0;
-	m_removedFdHandlers.emplace(fd, fd_it->second);
+	if(!(fdHandler->epollEvents & EPOLLONESHOT))
+	{
+		UF_TRACE(TRACE_ERROR, "rearmFd - FD ", fd, " was not registered in one-shot mode!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
 
-	m_fdHandlers.erase(fd_it);
+	// Re-arming reuses the already converted epoll events, flushFdChanges() always re-arms dirty one-shot FDs
+	if(fdHandler->isDirty)
+	{
+		increaseCounter<uint64_t>(m_coalescedUpdates, 1);
+	} else
+	{
+		fdHandler->isDirty = true;
+		m_dirtyFds.push_back(fd);
+	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("removeFdHandler - Removed FD ", fd, " handler successfully!"));
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
-IEventLoop::ReturnCode EventLoopImpl::run()
+IEventLoop::ReturnCode EventLoopImpl::addFdGroup(FdGroupCallbackFunc&& callback, uint32_t& groupId)
 {
 	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("run - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "addFdGroup - Not a thread local!");
 		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("run - Starting Event Loop..."));
-	m_isRunning = true;
+	if(!callback)
+	{
+		UF_TRACE(TRACE_ERROR, "addFdGroup - Invalid callback!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	std::unique_ptr<FdGroup> group(new FdGroup());
+	group->id = m_nextFdGroupId++;
+	group->callback = std::move(callback);
+	groupId = group->id;
+	m_fdGroups.emplace(groupId, std::move(group));
 
-	const int maxEvents = 3;
-	struct epoll_event events[maxEvents];
+	UF_TRACE(TRACE_INFO, "addFdGroup - Added group ", groupId, " successfully!");
+	return IEventLoop::ReturnCode::NORMAL;
+}
 
-	while(m_isRunning && !m_fdHandlers.empty())
+IEventLoop::ReturnCode EventLoopImpl::addFdToGroup(uint32_t groupId, int fd, uint32_t eventMask)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		// Clear all almost deleted FD Handlers in the previous event batch
-		m_removedFdHandlers.clear();
+		UF_TRACE(TRACE_ERROR, "addFdToGroup - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
 
-		// Wait infinitely until receive an enough number (maxEvents) of events for all FDs in the interest list
-		// or epoll_wait() is unblocked due to any reason such as another thread has added a new FD
-		// to the interest list,...
-		int eventCount = m_syscallWrapper->epoll_wait(m_epfd, events, maxEvents, -1);
+	auto iter = m_fdGroups.find(groupId);
+	if(iter == m_fdGroups.end())
+	{
+		UF_TRACE(TRACE_ERROR, "addFdToGroup - Group ", groupId, " not found!");
+		return IEventLoop::ReturnCode::NOT_FOUND;
+	}
 
-		if(eventCount > 0)
-		{
-			TPT_TRACE(TRACE_INFO, SSTR("run - Current batch: num events: ", eventCount));
-			for(int i = 0; i < eventCount; ++i)
-			{
-				handleEpollEvent(events[i]);
-			}	
-		} else if (eventCount == -1 && errno != EINTR)
-		{
-			TPT_TRACE(TRACE_ERROR, SSTR("run - Failed to epoll_wait()"));
-			return IEventLoop::ReturnCode::INTERNAL_FAULT;
-		}
+	// Registered like any other FD, only without a callback of its own
+	IEventLoop::ReturnCode rc = addFdHandler(fd, eventMask, nullptr, FdPriority::Normal);
+	if(rc != IEventLoop::ReturnCode::NORMAL)
+	{
+		return rc;
 	}
 
+	findFdHandler(fd)->group = iter->second.get();
+	++iter->second->fdCount;
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
-IEventLoop::ReturnCode EventLoopImpl::stop()
+IEventLoop::ReturnCode EventLoopImpl::removeFdGroup(uint32_t groupId)
 {
 	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("stop - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "removeFdGroup - Not a thread local!");
 		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
-	m_isRunning = false;
+	auto iter = m_fdGroups.find(groupId);
+	if(iter == m_fdGroups.end())
+	{
+		UF_TRACE(TRACE_ERROR, "removeFdGroup - Group ", groupId, " not found!");
+		return IEventLoop::ReturnCode::NOT_FOUND;
+	}
+
+	// Groups do not keep a list of their FDs, removing a whole group is rare enough to walk the FD table instead
+	FdGroup* group = iter->second.get();
+	for(size_t page = 0; page < m_fdHandlerPages.size() && group->fdCount > 0; ++page)
+	{
+		if(!m_fdHandlerPages[page])
+		{
+			continue;
+		}
+
+		for(size_t i = 0; i < FdHandlersPerPage; ++i)
+		{
+			if(m_fdHandlerPages[page][i].epollEvents != 0 && m_fdHandlerPages[page][i].group == group)
+			{
+				(void)removeFdHandler(static_cast<int>(page * FdHandlersPerPage + i));
+			}
+		}
+	}
+
+	m_fdGroups.erase(iter);
 
-	TPT_TRACE(TRACE_INFO, SSTR("stop - Exiting Event Loop..."));
+	UF_TRACE(TRACE_INFO, "removeFdGroup - Removed group ", groupId, " successfully!");
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
-void EventLoopImpl::handleEpollEvent(const struct epoll_event& event)
+IEventLoop::ReturnCode EventLoopImpl::removeFdHandler(int fd)
 {
-	FdHandler* fdHandler = static_cast<FdHandler*>(event.data.ptr);
-
-	uint32_t eventMask = convertToLocalEvents(event.events & fdHandler->epollEvents);
-	// For removed FDs, eventMask = 0, so those FD's callbacks will be skipped
-	TPT_TRACE(TRACE_INFO, SSTR("handleEpollEvent - event = ", +event.events, ", eventMask = ", +eventMask));
-	if(eventMask)
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		dispatchEvent(fdHandler->callback, fdHandler->fd, eventMask);
+		UF_TRACE(TRACE_ERROR, "removeFdHandler - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
 
-		executeScheduledEvents();
+	// Find in the table the respective fd
+	FdHandler* fdHandler = findFdHandler(fd);
+	if(fdHandler == nullptr)
+	{
+		UF_TRACE(TRACE_ERROR, "removeFdHandler - FD ", fd, " not found!");
+		return IEventLoop::ReturnCode::NOT_FOUND;
 	}
-}
 
-uint32_t EventLoopImpl::convertToEpollEvents(uint32_t localEvents)
-{
-	uint32_t epollEvents = 0;
+	// Request epoll instance to delete the fd from the interest list right away, the caller may close it next.
+	// A pending update of the fd is dropped with it.
+	increaseCounter<uint64_t>(m_epollCtlCalls, 1);
+	(void) EventLoopSyscalls::epoll_ctl(*m_syscallWrapper, m_epfd, EPOLL_CTL_DEL, fd, nullptr);
+	if(fdHandler->isDirty)
+	{
+		fdHandler->isDirty = false;
+		increaseCounter<uint64_t>(m_coalescedUpdates, 1);
+	}
 
-	if(localEvents & FdEventIn)
+	/*  Sometime, there could a not yet handled event for the removed FD in current batch.
+	*   An empty event mask marks the slot as free, so such events are skipped, and if the fd gets added again
+	*   meanwhile they are rejected because they carry the previous generation.
+	*/
+	fdHandler->epollEvents = 0;
+	if(fd == m_dispatchingFd)
 	{
-		epollEvents |= EPOLLIN;
-	} 
-	
-	if(localEvents & FdEventOut)
+		// Do not destroy the callback which is being executed, dispatchEvent() will do it once it returns
+		m_dispatchingFdCallback = nullptr;
+		m_isDispatchingFdChanged = true;
+	} else
 	{
-		epollEvents |= EPOLLOUT;
+		fdHandler->callback = nullptr;
+	}
+	--m_fdHandlerCount;
+	if(fdHandler->priority != FdPriority::Normal)
+	{
+		--m_prioritizedFdCount;
 	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("convertToEpollEvents - localEvents = ", +localEvents, ", epollEvents = %d", +epollEvents));
-	return epollEvents;
+	if(fdHandler->group != nullptr)
+	{
+		--fdHandler->group->fdCount;
+		fdHandler->group = nullptr;
+	}
+
+	UF_TRACE(TRACE_INFO, "removeFdHandler - Removed FD ", fd, " handler successfully!");
+	return IEventLoop::ReturnCode::NORMAL;
 }
 
-uint32_t EventLoopImpl::convertToLocalEvents(uint32_t epollEvents)
+IEventLoop::ReturnCode EventLoopImpl::run()
 {
-	uint32_t localEvents = 0;
-
-	if(epollEvents & EPOLLIN)
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
-		localEvents |= FdEventIn;
-	} 
-	
-	if(epollEvents & EPOLLOUT)
+		UF_TRACE(TRACE_ERROR, "run - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	UF_TRACE(TRACE_INFO, "run - Starting Event Loop...");
+	startRunning();
+
+	uint32_t dispatched = 0;
+	while(m_isRunning && m_fdHandlerCount > 0)
 	{
-		localEvents |= FdEventOut;
+		IEventLoop::ReturnCode result = runIteration(-1, dispatched);
+		if(result != IEventLoop::ReturnCode::NORMAL)
+		{
+			return result;
+		}
 	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("convertToLocalEvents - epollEvents = ", +epollEvents, ", localEvents = %d", +localEvents));
-	return localEvents;
+	return IEventLoop::ReturnCode::NORMAL;
 }
 
-void EventLoopImpl::dispatchEvent(const CallbackFunc& callback, int fd, uint32_t eventMask)
+IEventLoop::ReturnCode EventLoopImpl::runOnce(std::chrono::nanoseconds timeout, uint32_t& dispatched)
 {
-	TPT_TRACE(TRACE_INFO, SSTR("dispatchEvent - Invoking callback for fd  ", fd));
-    	callback(fd, eventMask);
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "runOnce - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	startRunning();
+
+	dispatched = 0;
+	return runIteration(timeout.count() < 0 ? -1 : timeout.count(), dispatched);
 }
 
-void EventLoopImpl::executeScheduledEvents()
+IEventLoop::ReturnCode EventLoopImpl::runUntil(std::chrono::steady_clock::time_point deadline, uint32_t& dispatched)
 {
-	auto it = m_scheduledEvents.begin();
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "runUntil - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	startRunning();
 
-	TPT_TRACE(TRACE_INFO, SSTR("executeScheduledEvents - m_scheduledEvents size = ", m_scheduledEvents.size()));
-	while(it != m_scheduledEvents.end())
+	dispatched = 0;
+	int64_t deadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+	int64_t nowNs = steadyNowNs();
+	do
 	{
-		auto eventHandler = *it;
-		m_scheduledEvents.erase(it);
+		// At least one iteration, a deadline already in the past still polls once
+		IEventLoop::ReturnCode result = runIteration(std::max<int64_t>(deadlineNs - nowNs, 0), dispatched);
+		if(result != IEventLoop::ReturnCode::NORMAL)
+		{
+			return result;
+		}
+		nowNs = steadyNowNs();
+	} while(m_isRunning && m_fdHandlerCount > 0 && nowNs < deadlineNs);
 
-		TPT_TRACE(TRACE_INFO, SSTR("executeScheduledEvents - Invoking eventHandler()!"));
-		eventHandler();
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+void EventLoopImpl::startRunning()
+{
+	m_isRunning = true;
 
-		// Note that: be careful with an infinite loop of executeScheduledEvents(), which means somehow eventHandler()
-		// above repeatedly add another event(s) to this m_scheduledEvents list again and again.
-		it = m_scheduledEvents.begin();
+	if(m_firstRunTimeNs.load(std::memory_order_relaxed) == 0)
+	{
+		m_firstRunTimeNs.store(steadyNowNs(), std::memory_order_relaxed);
 	}
 }
 
-IEventLoop::ReturnCode EventLoopImpl::scheduleEvent(const EventHandlerFunc& eventHandler)
+IEventLoop::ReturnCode EventLoopImpl::runIteration(int64_t timeoutNs, uint32_t& dispatched)
 {
-	// Check if current thread is thread local which owns this Event Loop instance
-	if(m_threadId != std::this_thread::get_id())
+	dispatched += executePostedEvents();
+	if(!m_isRunning)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("scheduleEvent - Not a thread local!"));
-		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+		return IEventLoop::ReturnCode::NORMAL;
+	}
+
+	// Without any FD handler there is nothing to wait for, but runOnce() still executes the scheduled events
+	if(m_fdHandlerCount > 0)
+	{
+		if(!m_dirtyFds.empty())
+		{
+			flushFdChanges();
+		}
+
+		// The event buffer is owned by the loop and only grows, so shrinking the batch never reallocates.
+		uint32_t batchSize = m_batchSize.load(std::memory_order_relaxed);
+		if(m_events.size() < batchSize)
+		{
+			m_events.resize(batchSize);
+		}
+
+		if(m_instrumentation && m_instrumentation->wakeupTimeNs != 0)
+		{
+			m_instrumentation->iterationTime.record(steadyNowNs() - m_instrumentation->wakeupTimeNs);
+		}
+
+		int eventCount = 0;
+		bool hasPendingEvents = !m_runningEvents.empty() || !m_scheduledEvents.empty() || !m_deferredEvents.empty();
+		int64_t waitDeadlineNs = timeoutNs > 0 ? steadyNowNs() + timeoutNs : INT64_MAX;
+		if(m_busyPollSpinNs == 0 || hasPendingEvents || timeoutNs == 0 ||
+			!busyPoll(static_cast<int>(batchSize), waitDeadlineNs, eventCount))
+		{
+			// Wait until receive at most batchSize events for all FDs in the interest list, the timeout expires
+			// or epoll_wait() is unblocked due to any reason such as another thread has added a new FD
+			// to the interest list,...
+			// Announce to post() producers that we are about to sleep, then re-check the queue: either we see their
+			// event or they see m_isPolling and write to m_wakeupFd. Both sides need a full fence between their store
+			// and load.
+			m_isPolling.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t waitNs = timeoutNs;
+			if(hasPendingEvents || !m_postedEvents.empty())
+			{
+				waitNs = 0;
+			} else if(timeoutNs > 0)
+			{
+				// Busy polling may have used a part of the timeout already
+				waitNs = std::max<int64_t>(waitDeadlineNs - steadyNowNs(), 0);
+			}
+
+			eventCount = waitEvents(static_cast<int>(batchSize), waitNs);
+			m_isPolling.store(false, std::memory_order_relaxed);
+			increaseCounter<uint64_t>(m_epollWaitCalls, 1);
+		}
+
+		if(m_instrumentation)
+		{
+			m_instrumentation->wakeupTimeNs = steadyNowNs();
+			if(eventCount > 0)
+			{
+				m_instrumentation->eventsPerBatch.record(eventCount);
+			}
+		}
+
+		if(eventCount > 0)
+		{
+			UF_TRACE(TRACE_INFO, "runIteration - Current batch: num events: ", eventCount, ", batch size: ", batchSize);
+			increaseCounter<uint64_t>(m_wakeups, 1);
+			increaseCounter<uint64_t>(m_readyEvents, eventCount);
+
+			dispatched += dispatchBatch(eventCount);
+			adaptBatchSize(eventCount);
+
+			if(m_busyPollSpinNs != 0)
+			{
+				m_lastEventTimeNs = steadyNowNs();
+			}
+		} else if (eventCount == -1 && errno != EINTR)
+		{
+			UF_TRACE(TRACE_ERROR, "runIteration - Failed to epoll_wait()");
+			return IEventLoop::ReturnCode::INTERNAL_FAULT;
+		} else if(!m_deferredEvents.empty())
+		{
+			dispatched += dispatchBatch(0);
+		}
+	}
+
+	if(!m_runningEvents.empty() || !m_scheduledEvents.empty())
+	{
+		dispatched += executeScheduledEvents();
+	}
+
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+int EventLoopImpl::waitEvents(int maxEvents, int64_t timeoutNs)
+{
+	// Whole milliseconds, including the infinite and zero timeouts of run(), do not need epoll_pwait2()
+	if(timeoutNs <= 0 || timeoutNs % 1000000 == 0)
+	{
+		return EventLoopSyscalls::epoll_wait(*m_syscallWrapper, m_epfd, m_events.data(), maxEvents,
+			timeoutNs < 0 ? -1 : static_cast<int>(std::min<int64_t>(timeoutNs / 1000000, INT32_MAX)));
+	}
+
+	struct timespec timeout;
+	timeout.tv_sec = timeoutNs / 1000000000LL;
+	timeout.tv_nsec = timeoutNs % 1000000000LL;
+	return EventLoopSyscalls::epoll_pwait2(*m_syscallWrapper, m_epfd, m_events.data(), maxEvents, &timeout);
+}
+
+IEventLoop::ReturnCode EventLoopImpl::stop()
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "stop - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	m_isRunning = false;
+
+	UF_TRACE(TRACE_INFO, "stop - Exiting Event Loop...");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+bool EventLoopImpl::busyPoll(int maxEvents, int64_t waitDeadlineNs, int& eventCount)
+{
+	int64_t startNs = steadyNowNs();
+	int64_t deadlineNs = std::min(m_lastEventTimeNs + m_busyPollSpinNs, waitDeadlineNs);
+	if(startNs >= deadlineNs)
+	{
+		// Too long since the last event, block right away
+		return false;
+	}
+
+	uint32_t pauses = m_busyPollPolicy.minPauses;
+	int64_t nowNs = startNs;
+	do
+	{
+		eventCount = EventLoopSyscalls::epoll_wait(*m_syscallWrapper, m_epfd, m_events.data(), maxEvents, 0);
+		increaseCounter<uint64_t>(m_epollWaitCalls, 1);
+
+		// m_isPolling stays false while spinning, so posted events are noticed here without any eventfd write
+		if(eventCount != 0 || !m_postedEvents.empty())
+		{
+			increaseCounter<uint64_t>(m_busyPollHits, 1);
+			increaseCounter<uint64_t>(m_busyPollTimeNs, steadyNowNs() - startNs);
+			return true;
+		}
+
+		for(uint32_t i = 0; i < pauses; ++i)
+		{
+			cpuRelax();
+		}
+		pauses = std::min(pauses * 2, m_busyPollPolicy.maxPauses);
+
+		nowNs = steadyNowNs();
+	} while(nowNs < deadlineNs);
+
+	UF_TRACE(TRACE_INFO, "busyPoll - No event within ", m_busyPollPolicy.spinTime.count(), "us, blocking");
+	increaseCounter<uint64_t>(m_busyPollMisses, 1);
+	increaseCounter<uint64_t>(m_busyPollTimeNs, nowNs - startNs);
+	return false;
+}
+
+void EventLoopImpl::adaptBatchSize(int eventCount)
+{
+	uint32_t batchSize = m_batchSize.load(std::memory_order_relaxed);
+	uint32_t count = static_cast<uint32_t>(eventCount);
+
+	if(count >= batchSize && batchSize < m_maxBatchSize)
+	{
+		// epoll_wait() filled the whole buffer, there are probably more ready FDs left in the kernel
+		m_underfilledBatches = 0;
+		m_batchSize.store(std::min(batchSize * 2, m_maxBatchSize), std::memory_order_relaxed);
+		UF_TRACE(TRACE_INFO, "adaptBatchSize - Grow batch size to ", m_batchSize.load(std::memory_order_relaxed));
+	} else if(count < batchSize / 4 && batchSize > m_minBatchSize)
+	{
+		// Shrink lazily, a single quiet batch between two bursts should not make us pay extra syscalls
+		if(++m_underfilledBatches >= ShrinkAfterUnderfilledBatches)
+		{
+			m_underfilledBatches = 0;
+			m_batchSize.store(std::max(batchSize / 2, m_minBatchSize), std::memory_order_relaxed);
+			UF_TRACE(TRACE_INFO, "adaptBatchSize - Shrink batch size to ", m_batchSize.load(std::memory_order_relaxed));
+		}
+	} else
+	{
+		m_underfilledBatches = 0;
+	}
+}
+
+void EventLoopImpl::flushFdChanges()
+{
+	for(int fd : m_dirtyFds)
+	{
+		// The fd may have been removed meanwhile, or removed then added again with a clean slot
+		FdHandler* fdHandler = findFdHandler(fd);
+		if(fdHandler == nullptr || !fdHandler->isDirty)
+		{
+			continue;
+		}
+		fdHandler->isDirty = false;
+
+		// A one-shot FD may be disabled in the kernel even though its mask did not change
+		if(fdHandler->epollEvents == fdHandler->kernelEvents && !(fdHandler->epollEvents & EPOLLONESHOT))
+		{
+			increaseCounter<uint64_t>(m_coalescedUpdates, 1);
+			continue;
+		}
+
+		struct epoll_event epEvent;
+		memset(&epEvent, 0, sizeof(struct epoll_event));
+		epEvent.events = fdHandler->epollEvents;
+		epEvent.data.u64 = makeEpollData(fd, fdHandler->generation);
+		increaseCounter<uint64_t>(m_epollCtlCalls, 1);
+		if(EventLoopSyscalls::epoll_ctl(*m_syscallWrapper, m_epfd, EPOLL_CTL_MOD, fd, &epEvent) == -1)
+		{
+			UF_TRACE(TRACE_ERROR, "flushFdChanges - Failed to epoll_ctl() with EPOLL_CTL_MOD for FD ", fd, ", errno = ", errno);
+			continue;
+		}
+		fdHandler->kernelEvents = fdHandler->epollEvents;
+	}
+
+	m_dirtyFds.clear();
+}
+
+uint32_t EventLoopImpl::dispatchBatch(int eventCount)
+{
+	uint32_t dispatched = 0;
+
+	// Nothing to order, dispatch the batch as returned by the kernel
+	if(m_prioritizedFdCount == 0 && m_deferredEvents.empty())
+	{
+		for(int i = 0; i < eventCount; ++i)
+		{
+			if(handleEpollEvent(m_events[i]))
+			{
+				++dispatched;
+			}
+		}
+
+		if(!m_readyFdGroups.empty())
+		{
+			dispatched += dispatchFdGroups();
+		}
+		return dispatched;
+	}
+
+	int64_t deadlineNs = m_lowPriorityBudget.count() > 0 ?
+		steadyNowNs() + std::chrono::duration_cast<std::chrono::nanoseconds>(m_lowPriorityBudget).count() : 0;
+
+	// One pass per class. The priority is looked up again in every pass, since a callback may have removed or re-added
+	// other FDs meanwhile, whose stale events are then skipped by handleEpollEvent()
+	for(int i = 0; i < eventCount; ++i)
+	{
+		if(getEventPriority(m_events[i]) == FdPriority::High && handleEpollEvent(m_events[i]))
+		{
+			++dispatched;
+		}
+	}
+
+	for(int i = 0; i < eventCount; ++i)
+	{
+		if(getEventPriority(m_events[i]) == FdPriority::Normal && handleEpollEvent(m_events[i]))
+		{
+			++dispatched;
+		}
+	}
+
+	// Groups only have Normal FDs
+	if(!m_readyFdGroups.empty())
+	{
+		dispatched += dispatchFdGroups();
+	}
+
+	// Deferred events come first, they already waited for one iteration
+	m_lowPriorityEvents.swap(m_deferredEvents);
+	for(int i = 0; i < eventCount; ++i)
+	{
+		if(getEventPriority(m_events[i]) == FdPriority::Low)
+		{
+			m_lowPriorityEvents.push_back(m_events[i]);
+		}
+	}
+
+	size_t index = 0;
+	for(; index < m_lowPriorityEvents.size(); ++index)
+	{
+		if(deadlineNs != 0 && steadyNowNs() >= deadlineNs)
+		{
+			break;
+		}
+
+		if(handleEpollEvent(m_lowPriorityEvents[index]))
+		{
+			++dispatched;
+		}
+	}
+
+	// Over budget: level-triggered FDs will be reported again by the next wait, only the other ones must be kept
+	for(; index < m_lowPriorityEvents.size(); ++index)
+	{
+		const struct epoll_event& event = m_lowPriorityEvents[index];
+		FdHandler* fdHandler = findFdHandler(static_cast<int>(event.data.u64 & 0xFFFFFFFFULL));
+		if(fdHandler == nullptr || fdHandler->generation != static_cast<uint32_t>(event.data.u64 >> 32))
+		{
+			continue;
+		}
+
+		if(fdHandler->epollEvents & (EPOLLET | EPOLLONESHOT))
+		{
+			m_deferredEvents.push_back(event);
+		}
+		increaseCounter<uint64_t>(m_deferredEventCount, 1);
+	}
+
+	if(!m_deferredEvents.empty())
+	{
+		UF_TRACE(TRACE_INFO, "dispatchBatch - Deferred ", m_deferredEvents.size(), " low priority events");
+	}
+
+	m_lowPriorityEvents.clear();
+	return dispatched;
+}
+
+IEventLoop::FdPriority EventLoopImpl::getEventPriority(const struct epoll_event& event)
+{
+	int fd = static_cast<int>(event.data.u64 & 0xFFFFFFFFULL);
+	uint32_t generation = static_cast<uint32_t>(event.data.u64 >> 32);
+
+	// The wakeup and stale events are handled in the first pass, the latter only to be skipped
+	FdHandler* fdHandler = findFdHandler(fd);
+	if(generation == WakeupGeneration || fdHandler == nullptr || fdHandler->generation != generation)
+	{
+		return FdPriority::High;
+	}
+
+	return fdHandler->priority;
+}
+
+bool EventLoopImpl::handleEpollEvent(const struct epoll_event& event)
+{
+	int fd = static_cast<int>(event.data.u64 & 0xFFFFFFFFULL);
+	uint32_t generation = static_cast<uint32_t>(event.data.u64 >> 32);
+	if(generation == WakeupGeneration)
+	{
+		handleWakeup();
+		return false;
+	}
+
+	// Events of removed FDs, or of a previous registration of a re-used fd number, are rejected here
+	FdHandler* fdHandler = findFdHandler(fd);
+	if(fdHandler == nullptr || fdHandler->generation != generation)
+	{
+		UF_TRACE(TRACE_INFO, "handleEpollEvent - Skip stale event for FD ", fd);
+		return false;
+	}
+
+	uint32_t eventMask = convertToLocalEvents(event.events & fdHandler->epollEvents);
+	UF_TRACE(TRACE_INFO, "handleEpollEvent - event = ", +event.events, ", eventMask = ", +eventMask);
+	if(eventMask == 0)
+	{
+		return false;
+	}
+
+	// FDs of a group are only collected here, the group callback is called once the batch has been dispatched
+	if(fdHandler->group != nullptr)
+	{
+		FdGroup& group = *fdHandler->group;
+		group.readyEvents.push_back(FdEvent{fd, eventMask});
+		group.readyGenerations.push_back(generation);
+		if(!group.isReady)
+		{
+			group.isReady = true;
+			m_readyFdGroups.push_back(group.id);
+		}
+		return false;
+	}
+
+	dispatchEvent(*fdHandler, fd, eventMask);
+	return true;
+}
+
+uint32_t EventLoopImpl::dispatchFdGroups()
+{
+	uint32_t dispatched = 0;
+
+	// A group callback may add or remove groups, so groups are looked up by id and the ready list is walked by index
+	for(size_t i = 0; i < m_readyFdGroups.size(); ++i)
+	{
+		auto iter = m_fdGroups.find(m_readyFdGroups[i]);
+		if(iter == m_fdGroups.end())
+		{
+			continue;
+		}
+
+		// Drop the events of FDs removed or re-registered since they were collected
+		FdGroup& group = *iter->second;
+		group.isReady = false;
+		size_t count = 0;
+		for(size_t j = 0; j < group.readyEvents.size(); ++j)
+		{
+			FdHandler* fdHandler = findFdHandler(group.readyEvents[j].fd);
+			if(fdHandler != nullptr && fdHandler->group == &group && fdHandler->generation == group.readyGenerations[j])
+			{
+				group.readyEvents[count++] = group.readyEvents[j];
+			}
+		}
+
+		if(count == 0)
+		{
+			group.readyEvents.clear();
+			group.readyGenerations.clear();
+			continue;
+		}
+
+		UF_TRACE(TRACE_INFO, "dispatchFdGroups - Invoking callback of group ", group.id, " for ", count, " FDs");
+		int64_t startNs = m_instrumentation ? steadyNowNs() : 0;
+
+		// The callback may remove its own group, so it must not be destroyed while it is executed. The events are
+		// moved out too, so that the buffers are reused by the next batch unless the group is gone.
+		uint32_t groupId = group.id;
+		FdGroupCallbackFunc callback = std::move(group.callback);
+		std::vector<FdEvent> readyEvents;
+		readyEvents.swap(group.readyEvents);
+		group.readyGenerations.clear();
+		callback(readyEvents.data(), count);
+		++dispatched;
+
+		if(startNs != 0 && m_instrumentation)
+		{
+			recordCallbackDuration(m_instrumentation->callbackLatency, readyEvents[0].fd, startNs);
+		}
+
+		iter = m_fdGroups.find(groupId);
+		if(iter != m_fdGroups.end())
+		{
+			readyEvents.clear();
+			iter->second->readyEvents.swap(readyEvents);
+			iter->second->callback = std::move(callback);
+		}
+	}
+
+	m_readyFdGroups.clear();
+	return dispatched;
+}
+
+EventLoopImpl::FdHandler* EventLoopImpl::findFdHandler(int fd)
+{
+	size_t page = static_cast<size_t>(fd) / FdHandlersPerPage;
+	if(fd < 0 || page >= m_fdHandlerPages.size() || !m_fdHandlerPages[page])
+	{
+		return nullptr;
+	}
+
+	FdHandler& fdHandler = m_fdHandlerPages[page][static_cast<size_t>(fd) % FdHandlersPerPage];
+	return fdHandler.epollEvents != 0 ? &fdHandler : nullptr;
+}
+
+EventLoopImpl::FdHandler& EventLoopImpl::getFdHandlerSlot(int fd)
+{
+	size_t page = static_cast<size_t>(fd) / FdHandlersPerPage;
+	if(page >= m_fdHandlerPages.size())
+	{
+		m_fdHandlerPages.resize(page + 1);
+	}
+
+	// Pages are never freed nor moved until the Event Loop is destroyed, so a callback being executed keeps its address
+	if(!m_fdHandlerPages[page])
+	{
+		m_fdHandlerPages[page].reset(new FdHandler[FdHandlersPerPage]);
+	}
+
+	return m_fdHandlerPages[page][static_cast<size_t>(fd) % FdHandlersPerPage];
+}
+
+uint32_t EventLoopImpl::convertToEpollEvents(uint32_t localEvents)
+{
+	uint32_t epollEvents = 0;
+
+	// Unknown bits are rejected rather than silently dropped
+	if(localEvents & ~(FdEventIn | FdEventOut | FdEventRdHup | FdEventErr | FdEventHup | \
+				FdModeEdgeTriggered | FdModeOneShot | FdModeExclusive))
+	{
+		UF_TRACE(TRACE_ERROR, "convertToEpollEvents - Unsupported localEvents = ", +localEvents);
+		return 0;
+	}
+
+	if(localEvents & FdEventIn)
+	{
+		epollEvents |= EPOLLIN;
+	} 
+	
+	if(localEvents & FdEventOut)
+	{
+		epollEvents |= EPOLLOUT;
+	}
+
+	if(localEvents & FdEventRdHup)
+	{
+		epollEvents |= EPOLLRDHUP;
+	}
+
+	if(localEvents & FdEventErr)
+	{
+		epollEvents |= EPOLLERR;
+	}
+
+	if(localEvents & FdEventHup)
+	{
+		epollEvents |= EPOLLHUP;
+	}
+
+	// Registration modes alone do not make a valid event mask
+	if(0 == epollEvents)
+	{
+		return 0;
+	}
+
+	if(localEvents & FdModeEdgeTriggered)
+	{
+		epollEvents |= EPOLLET;
+	}
+
+	if(localEvents & FdModeOneShot)
+	{
+		epollEvents |= EPOLLONESHOT;
+	}
+
+	if(localEvents & FdModeExclusive)
+	{
+		// Kernel refuses EPOLLEXCLUSIVE together with any other flags than these
+		if(epollEvents & ~(EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLET))
+		{
+			UF_TRACE(TRACE_ERROR, "convertToEpollEvents - FdModeExclusive is not allowed with localEvents = ", +localEvents);
+			return 0;
+		}
+		epollEvents |= EPOLLEXCLUSIVE;
+	}
+
+	UF_TRACE(TRACE_INFO, "convertToEpollEvents - localEvents = ", +localEvents, ", epollEvents = %d", +epollEvents);
+	return epollEvents;
+}
+
+uint32_t EventLoopImpl::convertToLocalEvents(uint32_t epollEvents)
+{
+	uint32_t localEvents = 0;
+
+	if(epollEvents & EPOLLIN)
+	{
+		localEvents |= FdEventIn;
+	} 
+	
+	if(epollEvents & EPOLLOUT)
+	{
+		localEvents |= FdEventOut;
+	}
+
+	if(epollEvents & EPOLLRDHUP)
+	{
+		localEvents |= FdEventRdHup;
+	}
+
+	if(epollEvents & EPOLLERR)
+	{
+		localEvents |= FdEventErr;
+	}
+
+	if(epollEvents & EPOLLHUP)
+	{
+		localEvents |= FdEventHup;
+	}
+
+	UF_TRACE(TRACE_INFO, "convertToLocalEvents - epollEvents = ", +epollEvents, ", localEvents = %d", +localEvents);
+	return localEvents;
+}
+
+void EventLoopImpl::dispatchEvent(FdHandler& fdHandler, int fd, uint32_t eventMask)
+{
+	UF_TRACE(TRACE_INFO, "dispatchEvent - Invoking callback for fd  ", fd);
+	m_dispatchingFd = fd;
+	if(!m_instrumentation)
+	{
+		fdHandler.callback(fd, eventMask);
+	} else
+	{
+		int64_t startNs = steadyNowNs();
+		if(m_instrumentation->wakeupTimeNs != 0)
+		{
+			m_instrumentation->dispatchLag.record(startNs - m_instrumentation->wakeupTimeNs);
+		}
+
+		fdHandler.callback(fd, eventMask);
+
+		// The callback may have disabled instrumentation
+		if(m_instrumentation)
+		{
+			recordCallbackDuration(m_instrumentation->callbackLatency, fd, startNs);
+		}
+	}
+	m_dispatchingFd = -1;
+
+	// The callback removed and/or re-added its own fd, the callback it just returned from can now be replaced
+	if(m_isDispatchingFdChanged)
+	{
+		m_isDispatchingFdChanged = false;
+		fdHandler.callback = std::move(m_dispatchingFdCallback);
+		m_dispatchingFdCallback = nullptr;
+	}
+}
+
+uint32_t EventLoopImpl::executeScheduledEvents()
+{
+	// Only take the events scheduled so far, the ones scheduled by the handlers below wait for the next iteration
+	if(m_runningEvents.empty())
+	{
+		m_runningEvents.swap(m_scheduledEvents);
+	}
+
+	UF_TRACE(TRACE_INFO, "executeScheduledEvents - m_runningEvents size = ", m_runningEvents.size());
+	int64_t deadlineNs = m_scheduledTimeBudget.count() > 0 ?
+		steadyNowNs() + std::chrono::duration_cast<std::chrono::nanoseconds>(m_scheduledTimeBudget).count() : 0;
+
+	uint32_t executed = 0;
+	EventHandlerFunc eventHandler;
+	while(m_runningEvents.pop(eventHandler))
+	{
+		UF_TRACE(TRACE_INFO, "executeScheduledEvents - Invoking eventHandler()!");
+		if(!m_instrumentation)
+		{
+			eventHandler();
+		} else
+		{
+			int64_t startNs = steadyNowNs();
+			eventHandler();
+
+			// The handler may have disabled instrumentation
+			if(m_instrumentation)
+			{
+				recordCallbackDuration(m_instrumentation->eventHandlerLatency, -1, startNs);
+			}
+		}
+		eventHandler = nullptr;
+		++executed;
+
+		if((m_scheduledEventBudget != 0 && executed >= m_scheduledEventBudget) || (deadlineNs != 0 && steadyNowNs() >= deadlineNs))
+		{
+			break;
+		}
+	}
+
+	increaseCounter<uint64_t>(m_scheduledEventCount, executed);
+	m_scheduledBacklog.store(m_runningEvents.size(), std::memory_order_relaxed);
+	return executed;
+}
+
+void EventLoopImpl::recordCallbackDuration(LogHistogram& histogram, int fd, int64_t startNs)
+{
+	int64_t durationNs = steadyNowNs() - startNs;
+	histogram.record(durationNs);
+
+	Instrumentation* instrumentation = m_instrumentation.get();
+	if(instrumentation->slowThresholdNs == 0 || durationNs < instrumentation->slowThresholdNs)
+	{
+		return;
+	}
+
+	++instrumentation->slowCallbacks;
+	UF_TRACE(TRACE_ABN, "recordCallbackDuration - Slow callback for FD ", fd, " took ", durationNs, "ns");
+
+	if(instrumentation->slowCallbackHandler)
+	{
+		// The handler may disable instrumentation, so it must not be destroyed while it is executed
+		SlowCallbackFunc slowCallbackHandler = std::move(instrumentation->slowCallbackHandler);
+		slowCallbackHandler(fd, std::chrono::nanoseconds(durationNs));
+		if(m_instrumentation.get() == instrumentation)
+		{
+			instrumentation->slowCallbackHandler = std::move(slowCallbackHandler);
+		}
+	}
+}
+
+void EventLoopImpl::handleWakeup()
+{
+	uint64_t counter;
+	(void)::read(m_wakeupFd, &counter, sizeof(counter));
+
+	// From now on producers have to write again, posted events themselves are executed at the next iteration
+	m_isWakeupPending.store(false, std::memory_order_release);
+}
+
+uint32_t EventLoopImpl::executePostedEvents()
+{
+	uint32_t executed = 0;
+	EventHandlerFunc eventHandler;
+	while(executed < MaxPostedEventsPerIteration && m_postedEvents.pop(eventHandler))
+	{
+		++executed;
+		UF_TRACE(TRACE_INFO, "executePostedEvents - Invoking posted eventHandler()!");
+		if(!m_instrumentation)
+		{
+			eventHandler();
+		} else
+		{
+			int64_t startNs = steadyNowNs();
+			eventHandler();
+
+			// The handler may have disabled instrumentation
+			if(m_instrumentation)
+			{
+				recordCallbackDuration(m_instrumentation->eventHandlerLatency, -1, startNs);
+			}
+		}
+	}
+
+	return executed;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::post(EventHandlerFunc&& eventHandler)
+{
+	if(!eventHandler)
+	{
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	if(m_wakeupFd == -1)
+	{
+		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+	}
+
+	m_postedEvents.push(std::move(eventHandler));
+
+	// Pairs with the fence in runIteration(), see there. While the loop is busy dispatching, or while another producer's
+	// wakeup has not been consumed yet, no system call is needed at all.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(m_isPolling.load(std::memory_order_relaxed) && !m_isWakeupPending.exchange(true, std::memory_order_acq_rel))
+	{
+		uint64_t one = 1;
+		if(::write(m_wakeupFd, &one, sizeof(one)) == -1)
+		{
+			m_isWakeupPending.store(false, std::memory_order_release);
+			return IEventLoop::ReturnCode::INTERNAL_FAULT;
+		}
+	}
+
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::scheduleEvent(EventHandlerFunc&& eventHandler)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "scheduleEvent - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	m_scheduledEvents.push(std::move(eventHandler));
+
+	UF_TRACE(TRACE_INFO, "scheduleEvent - Scheduled a new eventHandler to m_scheduledEvents successfully!");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::setScheduledEventBudget(uint32_t maxEvents, std::chrono::microseconds maxTime)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "setScheduledEventBudget - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(maxTime.count() < 0)
+	{
+		UF_TRACE(TRACE_ERROR, "setScheduledEventBudget - Invalid time budget ", maxTime.count(), "us!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	m_scheduledEventBudget = maxEvents;
+	m_scheduledTimeBudget = maxTime;
+
+	UF_TRACE(TRACE_INFO, "setScheduledEventBudget - Budget is now ", maxEvents, " events, ", maxTime.count(), "us");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::addSignalHandler(int signo, SignalHandlerFunc&& signalHandler)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "addSignalHandler - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	// SIGKILL and SIGSTOP can neither be blocked nor read from a signalfd
+	if(signo <= 0 || signo >= NSIG || signo == SIGKILL || signo == SIGSTOP || !signalHandler)
+	{
+		UF_TRACE(TRACE_ERROR, "addSignalHandler - Invalid signal ", signo);
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	if(sigismember(&m_signalMask, signo) == 1)
+	{
+		UF_TRACE(TRACE_ERROR, "addSignalHandler - Signal ", signo, " already has a handler");
+		return IEventLoop::ReturnCode::ALREADY_EXISTS;
+	}
+
+	// Block the signal first, otherwise it could still be delivered to its disposition between both calls
+	sigset_t signalSet;
+	sigset_t previousSet;
+	sigemptyset(&signalSet);
+	sigaddset(&signalSet, signo);
+	if(pthread_sigmask(SIG_BLOCK, &signalSet, &previousSet) != 0)
+	{
+		UF_TRACE(TRACE_ERROR, "addSignalHandler - Failed to block signal ", signo);
+		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+	}
+	bool isBlockedByUs = sigismember(&previousSet, signo) == 0;
+
+	sigset_t signalMask = m_signalMask;
+	sigaddset(&signalMask, signo);
+
+	// Changing the mask of an existing signalfd keeps its FD and its registration in the interest list
+	int signalFd = signalfd(m_signalFd, &signalMask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if(signalFd == -1)
+	{
+		UF_TRACE(TRACE_ERROR, "addSignalHandler - Failed to signalfd(), errno = ", errno);
+		if(isBlockedByUs)
+		{
+			pthread_sigmask(SIG_UNBLOCK, &signalSet, nullptr);
+		}
+		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+	}
+
+	if(m_signalFd == -1)
+	{
+		IEventLoop::ReturnCode rc = addFdHandler(signalFd, FdEventIn, [this](int fd, uint32_t) -> void
+		{
+			handleSignals(fd);
+		});
+		if(rc != IEventLoop::ReturnCode::NORMAL)
+		{
+			close(signalFd);
+			if(isBlockedByUs)
+			{
+				pthread_sigmask(SIG_UNBLOCK, &signalSet, nullptr);
+			}
+			return rc;
+		}
+		m_signalFd = signalFd;
+	}
+
+	if(m_signalHandlers.size() < static_cast<size_t>(NSIG))
+	{
+		m_signalHandlers.resize(NSIG);
+	}
+	m_signalHandlers[signo] = std::move(signalHandler);
+	m_signalMask = signalMask;
+	if(isBlockedByUs)
+	{
+		sigaddset(&m_blockedSignals, signo);
+	}
+
+	UF_TRACE(TRACE_INFO, "addSignalHandler - Added signal ", signo, " handler successfully!");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::removeSignalHandler(int signo)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "removeSignalHandler - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(signo <= 0 || signo >= NSIG || sigismember(&m_signalMask, signo) != 1)
+	{
+		UF_TRACE(TRACE_ERROR, "removeSignalHandler - Signal ", signo, " has no handler");
+		return IEventLoop::ReturnCode::NOT_FOUND;
+	}
+
+	sigdelset(&m_signalMask, signo);
+	m_signalHandlers[signo] = nullptr;
+
+	if(sigisemptyset(&m_signalMask))
+	{
+		(void)removeFdHandler(m_signalFd);
+		close(m_signalFd);
+		m_signalFd = -1;
+	} else if(signalfd(m_signalFd, &m_signalMask, SFD_NONBLOCK | SFD_CLOEXEC) == -1)
+	{
+		UF_TRACE(TRACE_ERROR, "removeSignalHandler - Failed to update signalfd mask, errno = ", errno);
+	}
+
+	// Unblock last, so that a pending instance of the signal is not delivered to its default disposition while
+	// the signalfd still watches it
+	if(sigismember(&m_blockedSignals, signo) == 1)
+	{
+		sigset_t signalSet;
+		sigemptyset(&signalSet);
+		sigaddset(&signalSet, signo);
+		pthread_sigmask(SIG_UNBLOCK, &signalSet, nullptr);
+		sigdelset(&m_blockedSignals, signo);
+	}
+
+	UF_TRACE(TRACE_INFO, "removeSignalHandler - Removed signal ", signo, " handler successfully!");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+void EventLoopImpl::handleSignals(int signalFd)
+{
+	struct signalfd_siginfo infos[SignalInfoBatch];
+	while(m_signalFd == signalFd)
+	{
+		ssize_t size = ::read(signalFd, infos, sizeof(infos));
+		if(size <= 0)
+		{
+			// EAGAIN, all pending signals have been consumed
+			break;
+		}
+
+		size_t count = static_cast<size_t>(size) / sizeof(struct signalfd_siginfo);
+		for(size_t i = 0; i < count && m_signalFd == signalFd; ++i)
+		{
+			int signo = static_cast<int>(infos[i].ssi_signo);
+			if(signo <= 0 || signo >= NSIG || !m_signalHandlers[signo])
+			{
+				continue;
+			}
+
+			// The handler may remove or replace itself, so it is moved out while it runs and only put back if its
+			// slot is still registered and empty
+			SignalHandlerFunc signalHandler = std::move(m_signalHandlers[signo]);
+			m_signalHandlers[signo] = nullptr;
+			signalHandler(infos[i]);
+
+			if(sigismember(&m_signalMask, signo) == 1 && !m_signalHandlers[signo])
+			{
+				m_signalHandlers[signo] = std::move(signalHandler);
+			}
+		}
+
+		if(count < SignalInfoBatch)
+		{
+			break;
+		}
+	}
+}
+
+IEventLoop::ReturnCode EventLoopImpl::addRelay(int sourceFd, int sinkFd, RelayDoneFunc&& doneHandler)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "addRelay - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	// splice() only honours SPLICE_F_NONBLOCK on the pipe side, the FDs themselves have to be non-blocking
+	int sourceFlags = sourceFd < 0 ? -1 : fcntl(sourceFd, F_GETFL);
+	int sinkFlags = sinkFd < 0 ? -1 : fcntl(sinkFd, F_GETFL);
+	if(sourceFd == sinkFd || sourceFlags == -1 || sinkFlags == -1 || !(sourceFlags & O_NONBLOCK) || !(sinkFlags & O_NONBLOCK))
+	{
+		UF_TRACE(TRACE_ERROR, "addRelay - Invalid or blocking FDs ", sourceFd, " -> ", sinkFd);
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	if(m_relays.find(sourceFd) != m_relays.end())
+	{
+		UF_TRACE(TRACE_ABN, "addRelay - FD ", sourceFd, " is already relayed!");
+		return IEventLoop::ReturnCode::ALREADY_EXISTS;
+	}
+
+	std::unique_ptr<Relay> relay(new Relay());
+	relay->sourceFd = sourceFd;
+	relay->sinkFd = sinkFd;
+	relay->doneHandler = std::move(doneHandler);
+	if(pipe2(relay->pipeFds, O_NONBLOCK | O_CLOEXEC) == -1)
+	{
+		UF_TRACE(TRACE_ERROR, "addRelay - Failed to pipe2(), errno = ", errno);
+		return IEventLoop::ReturnCode::INTERNAL_FAULT;
+	}
+	int pipeSize = fcntl(relay->pipeFds[1], F_GETPIPE_SZ);
+	relay->pipeCapacity = pipeSize > 0 ? static_cast<size_t>(pipeSize) : DefaultRelayPipeSize;
+
+	IEventLoop::ReturnCode rc = addFdHandler(sourceFd, RelaySourceEvents, [this, sourceFd](int, uint32_t) -> void
+	{
+		handleRelayEvent(sourceFd, false);
+	});
+	if(rc == IEventLoop::ReturnCode::NORMAL)
+	{
+		rc = addFdHandler(sinkFd, RelaySinkEvents, [this, sourceFd](int, uint32_t) -> void
+		{
+			handleRelayEvent(sourceFd, true);
+		});
+		if(rc != IEventLoop::ReturnCode::NORMAL)
+		{
+			(void)removeFdHandler(sourceFd);
+		}
+	}
+
+	if(rc != IEventLoop::ReturnCode::NORMAL)
+	{
+		UF_TRACE(TRACE_ERROR, "addRelay - Failed to register FDs ", sourceFd, " -> ", sinkFd);
+		close(relay->pipeFds[0]);
+		close(relay->pipeFds[1]);
+		return rc;
+	}
+
+	m_relays.emplace(sourceFd, std::move(relay));
+
+	UF_TRACE(TRACE_INFO, "addRelay - Relaying FD ", sourceFd, " to FD ", sinkFd);
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::removeRelay(int sourceFd)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "removeRelay - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	auto iter = m_relays.find(sourceFd);
+	if(iter == m_relays.end())
+	{
+		UF_TRACE(TRACE_ERROR, "removeRelay - FD ", sourceFd, " is not relayed");
+		return IEventLoop::ReturnCode::NOT_FOUND;
+	}
+
+	closeRelay(iter);
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::getRelayStatistics(int sourceFd, RelayStatistics& statistics) const
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "getRelayStatistics - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	auto iter = m_relays.find(sourceFd);
+	if(iter == m_relays.end())
+	{
+		return IEventLoop::ReturnCode::NOT_FOUND;
+	}
+
+	statistics = iter->second->statistics;
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+void EventLoopImpl::handleRelayEvent(int sourceFd, bool isSinkEvent)
+{
+	auto iter = m_relays.find(sourceFd);
+	if(iter == m_relays.end())
+	{
+		return;
+	}
+
+	Relay& relay = *iter->second;
+	if(isSinkEvent)
+	{
+		// The sink is one-shot, so it is disarmed again now
+		relay.isSinkWaiting = false;
+		(void)flushRelay(relay);
+	} else if(!relay.isSourcePaused)
+	{
+		fillRelay(relay);
+	}
+
+	// Only closed here, once nothing down the call stack uses the relay any more
+	if(relay.isDone)
+	{
+		closeRelay(iter);
+	}
+}
+
+void EventLoopImpl::fillRelay(Relay& relay)
+{
+	while(!relay.isDone)
+	{
+		size_t space = relay.pipeCapacity - relay.bufferedBytes;
+		ssize_t size = space == 0 ? -1 : splice(relay.sourceFd, nullptr, relay.pipeFds[1], nullptr, space, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if(size > 0)
+		{
+			relay.bufferedBytes += static_cast<size_t>(size);
+			if(!relay.isSinkWaiting)
+			{
+				(void)flushRelay(relay);
+			}
+		} else if(size == 0)
+		{
+			// End of file, the relay is done once the pipe has been drained
+			relay.isSourceClosed = true;
+			(void)removeFdHandler(relay.sourceFd);
+			relay.isDone = relay.isDone || relay.bufferedBytes == 0;
+			return;
+		} else if(space == 0 || errno == EAGAIN)
+		{
+			// Either the source is drained, or the pipe is full because the sink is slow. Stop polling the source
+			// in the latter case until flushRelay() has emptied the pipe.
+			if(relay.isSinkWaiting)
+			{
+				relay.isSourcePaused = updateFdEvents(relay.sourceFd, RelaySourceEvents | FdModeOneShot) == IEventLoop::ReturnCode::NORMAL;
+				++relay.statistics.sourceStalls;
+			}
+			return;
+		} else if(errno != EINTR)
+		{
+			UF_TRACE(TRACE_ERROR, "fillRelay - Failed to splice() from FD ", relay.sourceFd, ", errno = ", errno);
+			relay.error = errno;
+			relay.isDone = true;
+		}
+	}
+}
+
+bool EventLoopImpl::flushRelay(Relay& relay)
+{
+	// The sink may be a socket or pipe whose reader has gone, the relay then ends with EPIPE
+	SigPipeGuard sigPipeGuard;
+	while(relay.bufferedBytes > 0)
+	{
+		ssize_t size = splice(relay.pipeFds[0], nullptr, relay.sinkFd, nullptr, relay.bufferedBytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if(size == -1 && errno == EPIPE)
+		{
+			sigPipeGuard.drain();
+		}
+
+		if(size > 0)
+		{
+			relay.bufferedBytes -= static_cast<size_t>(size);
+			relay.statistics.bytesRelayed += static_cast<uint64_t>(size);
+		} else if(size == -1 && errno == EAGAIN)
+		{
+			++relay.statistics.sinkStalls;
+			relay.isSinkWaiting = rearmFd(relay.sinkFd) == IEventLoop::ReturnCode::NORMAL;
+			if(!relay.isSinkWaiting)
+			{
+				relay.error = EIO;
+				relay.isDone = true;
+			}
+			return false;
+		} else if(size == 0 || errno != EINTR)
+		{
+			UF_TRACE(TRACE_ERROR, "flushRelay - Failed to splice() to FD ", relay.sinkFd, ", errno = ", errno);
+			relay.error = size == 0 ? EPIPE : errno;
+			relay.isDone = true;
+			return false;
+		}
+	}
+
+	if(relay.isSourcePaused)
+	{
+		relay.isSourcePaused = false;
+		(void)updateFdEvents(relay.sourceFd, RelaySourceEvents);
+	}
+	relay.isDone = relay.isDone || relay.isSourceClosed;
+	return true;
+}
+
+void EventLoopImpl::closeRelay(std::unordered_map<int, std::unique_ptr<Relay>>::iterator iter)
+{
+	std::unique_ptr<Relay> relay = std::move(iter->second);
+	m_relays.erase(iter);
+
+	if(!relay->isSourceClosed)
+	{
+		(void)removeFdHandler(relay->sourceFd);
+	}
+	(void)removeFdHandler(relay->sinkFd);
+	close(relay->pipeFds[0]);
+	close(relay->pipeFds[1]);
+
+	UF_TRACE(TRACE_INFO, "closeRelay - FD ", relay->sourceFd, " relayed ", relay->statistics.bytesRelayed, " bytes");
+	if(relay->isDone && relay->doneHandler)
+	{
+		relay->doneHandler(relay->sourceFd, relay->error, relay->statistics);
+	}
+}
+
+IEventLoop::ReturnCode EventLoopImpl::setEpollBatchSize(uint32_t minEvents, uint32_t maxEvents)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "setEpollBatchSize - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	// epoll_wait() takes the batch size as an int
+	if(minEvents == 0 || minEvents > maxEvents || maxEvents > static_cast<uint32_t>(INT32_MAX))
+	{
+		UF_TRACE(TRACE_ERROR, "setEpollBatchSize - Invalid batch size range [", minEvents, ", ", maxEvents, "]!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	m_minBatchSize = minEvents;
+	m_maxBatchSize = maxEvents;
+	m_underfilledBatches = 0;
+	m_batchSize.store(minEvents, std::memory_order_relaxed);
+
+	UF_TRACE(TRACE_INFO, "setEpollBatchSize - Batch size range is now [", minEvents, ", ", maxEvents, "]");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::EpollStatistics EventLoopImpl::getEpollStatistics() const
+{
+	EpollStatistics stats;
+	stats.epollWaitCalls = m_epollWaitCalls.load(std::memory_order_relaxed);
+	stats.wakeups = m_wakeups.load(std::memory_order_relaxed);
+	stats.readyEvents = m_readyEvents.load(std::memory_order_relaxed);
+	stats.epollCtlCalls = m_epollCtlCalls.load(std::memory_order_relaxed);
+	stats.coalescedUpdates = m_coalescedUpdates.load(std::memory_order_relaxed);
+	stats.currentBatchSize = m_batchSize.load(std::memory_order_relaxed);
+	stats.scheduledEvents = m_scheduledEventCount.load(std::memory_order_relaxed);
+	stats.scheduledBacklog = m_scheduledBacklog.load(std::memory_order_relaxed);
+	stats.busyPollHits = m_busyPollHits.load(std::memory_order_relaxed);
+	stats.busyPollMisses = m_busyPollMisses.load(std::memory_order_relaxed);
+	stats.busyPollTimeNs = m_busyPollTimeNs.load(std::memory_order_relaxed);
+	stats.deferredEvents = m_deferredEventCount.load(std::memory_order_relaxed);
+	stats.busyPollSpinTimeUs = m_busyPollSpinNs / 1000;
+
+	if(stats.wakeups > 0)
+	{
+		stats.avgEventsPerWakeup = static_cast<double>(stats.readyEvents) / static_cast<double>(stats.wakeups);
+	}
+
+	int64_t firstRunTimeNs = m_firstRunTimeNs.load(std::memory_order_relaxed);
+	int64_t elapsedNs = steadyNowNs() - firstRunTimeNs;
+	if(firstRunTimeNs != 0 && elapsedNs > 0)
+	{
+		stats.syscallsPerSecond = static_cast<double>(stats.epollWaitCalls) * 1e9 / static_cast<double>(elapsedNs);
+	}
+
+	return stats;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::setLowPriorityBudget(std::chrono::microseconds maxTime)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "setLowPriorityBudget - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(maxTime.count() < 0)
+	{
+		UF_TRACE(TRACE_ERROR, "setLowPriorityBudget - Invalid time budget ", maxTime.count(), "us!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	m_lowPriorityBudget = maxTime;
+
+	UF_TRACE(TRACE_INFO, "setLowPriorityBudget - Budget is now ", maxTime.count(), "us");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::setBusyPollPolicy(const BusyPollPolicy& policy)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "setBusyPollPolicy - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(policy.spinTime.count() < 0 || policy.minPauses > policy.maxPauses)
+	{
+		UF_TRACE(TRACE_ERROR, "setBusyPollPolicy - Invalid policy, spinTime = ", policy.spinTime.count(), "us, pauses = [",
+		         policy.minPauses, ", ", policy.maxPauses, "]!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	m_busyPollPolicy = policy;
+	m_busyPollSpinNs = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.spinTime).count();
+	m_lastEventTimeNs = 0;
+
+	UF_TRACE(TRACE_INFO, "setBusyPollPolicy - Spin time is now ", policy.spinTime.count(), "us");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::enableInstrumentation(std::chrono::nanoseconds slowThreshold, SlowCallbackFunc&& slowCallbackHandler)
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "enableInstrumentation - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(slowThreshold.count() < 0)
+	{
+		UF_TRACE(TRACE_ERROR, "enableInstrumentation - Invalid slow threshold ", slowThreshold.count(), "ns!");
+		return IEventLoop::ReturnCode::INVALID_ARG;
+	}
+
+	if(m_instrumentation)
+	{
+		UF_TRACE(TRACE_ABN, "enableInstrumentation - Instrumentation already enabled!");
+		return IEventLoop::ReturnCode::ALREADY_EXISTS;
+	}
+
+	m_instrumentation = std::make_unique<Instrumentation>();
+	m_instrumentation->slowThresholdNs = slowThreshold.count();
+	m_instrumentation->slowCallbackHandler = std::move(slowCallbackHandler);
+
+	UF_TRACE(TRACE_INFO, "enableInstrumentation - Enabled, slow threshold = ", slowThreshold.count(), "ns");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::disableInstrumentation()
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "disableInstrumentation - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	m_instrumentation.reset();
+
+	UF_TRACE(TRACE_INFO, "disableInstrumentation - Disabled");
+	return IEventLoop::ReturnCode::NORMAL;
+}
+
+IEventLoop::ReturnCode EventLoopImpl::getInstrumentationSnapshot(InstrumentationSnapshot& snapshot) const
+{
+	// Check if current thread is thread local which owns this Event Loop instance
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
+	{
+		UF_TRACE(TRACE_ERROR, "getInstrumentationSnapshot - Not a thread local!");
+		return IEventLoop::ReturnCode::NOT_THREAD_LOCAL;
+	}
+
+	if(!m_instrumentation)
+	{
+		return IEventLoop::ReturnCode::NOT_FOUND;
 	}
 
-	m_scheduledEvents.push_back(eventHandler);
+	fillHistogramSnapshot(m_instrumentation->callbackLatency, snapshot.callbackLatency);
+	fillHistogramSnapshot(m_instrumentation->eventHandlerLatency, snapshot.eventHandlerLatency);
+	fillHistogramSnapshot(m_instrumentation->dispatchLag, snapshot.dispatchLag);
+	fillHistogramSnapshot(m_instrumentation->iterationTime, snapshot.iterationTime);
+	fillHistogramSnapshot(m_instrumentation->eventsPerBatch, snapshot.eventsPerBatch);
+	snapshot.slowCallbacks = m_instrumentation->slowCallbacks;
 
-	TPT_TRACE(TRACE_INFO, SSTR("scheduleEvent - Scheduled a new eventHandler to m_scheduledEvents successfully!"));
 	return IEventLoop::ReturnCode::NORMAL;
 }
 
@@ -0,0 +1,435 @@
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+
+#include "eventLoopIoUringWrapper.h"
+
+// Same as static function in C, all functions in this anonymous namespace are private and have only this-file scope.
+namespace
+{
+
+int ioUringSetup(uint32_t entries, struct io_uring_params* params)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags, const void* arg, size_t argSize)
+{
+	return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+/* Ring indexes are shared with the kernel, the same acquire/release pairs as liburing are used */
+inline uint32_t loadAcquire(const uint32_t* ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+inline void storeRelease(uint32_t* ptr, uint32_t value)
+{
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/* The poll32_events field is stored with its half words swapped on big endian machines, like liburing does */
+inline uint32_t toPoll32Events(uint32_t epollEvents)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	epollEvents = (epollEvents << 16) | (epollEvents >> 16);
+#endif
+	return epollEvents;
+}
+
+}
+
+EventLoopIoUringWrapper::~EventLoopIoUringWrapper()
+{
+	// The ring FD itself is owned and closed by EventLoopImpl, like an epoll FD would be
+	unmapRing();
+}
+
+int EventLoopIoUringWrapper::epoll_create1(int flags)
+{
+	(void)flags; // io_uring FDs are always created with O_CLOEXEC
+
+	if(m_ringFd != -1)
+	{
+		errno = EBUSY;
+		return -1;
+	}
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = CompletionQueueSize;
+
+	int ringFd = ioUringSetup(SubmissionQueueSize, &params);
+	if(ringFd == -1)
+	{
+		return -1;
+	}
+
+	// Timed waits need IORING_ENTER_EXT_ARG and we must never lose a completion when the CQ ring overflows
+	if(!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP))
+	{
+		close(ringFd);
+		errno = ENOSYS;
+		return -1;
+	}
+
+	m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+	}
+
+	m_sqRingPtr = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if(m_sqRingPtr == MAP_FAILED)
+	{
+		m_sqRingPtr = nullptr;
+		close(ringFd);
+		return -1;
+	}
+
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		m_cqRingPtr = m_sqRingPtr;
+	} else
+	{
+		m_cqRingPtr = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		if(m_cqRingPtr == MAP_FAILED)
+		{
+			m_cqRingPtr = nullptr;
+			unmapRing();
+			close(ringFd);
+			return -1;
+		}
+	}
+
+	m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if(sqes == MAP_FAILED)
+	{
+		unmapRing();
+		close(ringFd);
+		return -1;
+	}
+	m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+	char* sqRing = static_cast<char*>(m_sqRingPtr);
+	m_sqHead = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.head);
+	m_sqTail = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.tail);
+	m_sqArray = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.array);
+	m_sqMask = *reinterpret_cast<uint32_t*>(sqRing + params.sq_off.ring_mask);
+	m_sqEntries = params.sq_entries;
+
+	char* cqRing = static_cast<char*>(m_cqRingPtr);
+	m_cqHead = reinterpret_cast<uint32_t*>(cqRing + params.cq_off.head);
+	m_cqTail = reinterpret_cast<uint32_t*>(cqRing + params.cq_off.tail);
+	m_cqes = reinterpret_cast<struct io_uring_cqe*>(cqRing + params.cq_off.cqes);
+	m_cqMask = *reinterpret_cast<uint32_t*>(cqRing + params.cq_off.ring_mask);
+
+	m_ringFd = ringFd;
+	return m_ringFd;
+}
+
+int EventLoopIoUringWrapper::epoll_ctl(int epfd, int op, int fd, struct epoll_event* event)
+{
+	if(epfd != m_ringFd || fd < 0 || (op != EPOLL_CTL_DEL && event == nullptr))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	auto reg_it = m_registrations.find(fd);
+
+	switch(op)
+	{
+	case EPOLL_CTL_ADD:
+	{
+		if(reg_it != m_registrations.end())
+		{
+			errno = EEXIST;
+			return -1;
+		}
+
+		Registration registration;
+		registration.epollEvents = event->events;
+		registration.data = event->data;
+		registration.generation = m_nextGeneration++;
+		if(!queuePollAdd(fd, registration))
+		{
+			return -1;
+		}
+
+		m_registrations.emplace(fd, registration);
+		return 0;
+	}
+
+	case EPOLL_CTL_MOD:
+	{
+		if(reg_it == m_registrations.end())
+		{
+			errno = ENOENT;
+			return -1;
+		}
+
+		// Cancel the current poll request, completions still in flight are dropped thanks to the new generation
+		if(reg_it->second.isArmed && !queuePollRemove(fd, reg_it->second))
+		{
+			return -1;
+		}
+
+		reg_it->second.epollEvents = event->events;
+		reg_it->second.data = event->data;
+		reg_it->second.generation = m_nextGeneration++;
+		return queuePollAdd(fd, reg_it->second) ? 0 : -1;
+	}
+
+	case EPOLL_CTL_DEL:
+	{
+		if(reg_it == m_registrations.end())
+		{
+			errno = ENOENT;
+			return -1;
+		}
+
+		if(reg_it->second.isArmed)
+		{
+			(void)queuePollRemove(fd, reg_it->second);
+		}
+
+		m_registrations.erase(reg_it);
+		return 0;
+	}
+
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+int EventLoopIoUringWrapper::epoll_wait(int epfd, struct epoll_event* events, int maxEvents, int timeout)
+{
+	return wait(epfd, events, maxEvents, timeout < 0 ? -1 : static_cast<int64_t>(timeout) * 1000000LL);
+}
+
+int EventLoopIoUringWrapper::epoll_pwait2(int epfd, struct epoll_event* events, int maxEvents, const struct timespec* timeout)
+{
+	// io_uring_enter() takes the timeout as a timespec already, so no rounding to milliseconds is needed
+	return wait(epfd, events, maxEvents,
+		timeout == nullptr ? -1 : static_cast<int64_t>(timeout->tv_sec) * 1000000000LL + timeout->tv_nsec);
+}
+
+int EventLoopIoUringWrapper::wait(int epfd, struct epoll_event* events, int maxEvents, int64_t timeoutNs)
+{
+	if(epfd != m_ringFd || maxEvents <= 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	// Completions which are already posted in the CQ ring are returned without entering the kernel at all
+	int eventCount = reapCompletions(events, maxEvents);
+	if(eventCount > 0)
+	{
+		return eventCount;
+	}
+
+	// Nothing completed yet: submit every queued registration change and wait in the same system call
+	uint32_t toSubmit = *m_sqTail - loadAcquire(m_sqHead);
+	if(timeoutNs == 0 && toSubmit == 0)
+	{
+		return 0;
+	}
+
+	if(enter(timeoutNs == 0 ? 0 : 1, timeoutNs) == -1)
+	{
+		return -1;
+	}
+
+	return reapCompletions(events, maxEvents);
+}
+
+struct io_uring_sqe* EventLoopIoUringWrapper::getSqe()
+{
+	uint32_t tail = *m_sqTail;
+	if(tail - loadAcquire(m_sqHead) >= m_sqEntries)
+	{
+		// Submission ring is full of registration changes, hand them to the kernel without waiting
+		if(enter(0, 0) == -1 || *m_sqTail - loadAcquire(m_sqHead) >= m_sqEntries)
+		{
+			errno = EAGAIN;
+			return nullptr;
+		}
+	}
+
+	uint32_t index = tail & m_sqMask;
+	struct io_uring_sqe* sqe = &m_sqes[index];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	m_sqArray[index] = index;
+	return sqe;
+}
+
+bool EventLoopIoUringWrapper::queuePollAdd(int fd, Registration& registration)
+{
+	struct io_uring_sqe* sqe = getSqe();
+	if(sqe == nullptr)
+	{
+		return false;
+	}
+
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->user_data = makeUserData(fd, registration.generation);
+	// EPOLLET and EPOLLONESHOT are expressed by the kind of poll request rather than by the poll mask
+	sqe->poll32_events = toPoll32Events(registration.epollEvents & ~(EPOLLET | EPOLLONESHOT));
+	if((registration.epollEvents & EPOLLET) && !(registration.epollEvents & EPOLLONESHOT))
+	{
+		sqe->len = IORING_POLL_ADD_MULTI;
+	}
+
+	storeRelease(m_sqTail, *m_sqTail + 1);
+	registration.isArmed = true;
+	return true;
+}
+
+bool EventLoopIoUringWrapper::queuePollRemove(int fd, const Registration& registration)
+{
+	struct io_uring_sqe* sqe = getSqe();
+	if(sqe == nullptr)
+	{
+		return false;
+	}
+
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = makeUserData(fd, registration.generation);
+	sqe->user_data = PollRemoveUserData;
+
+	storeRelease(m_sqTail, *m_sqTail + 1);
+	return true;
+}
+
+int EventLoopIoUringWrapper::enter(uint32_t minComplete, int64_t timeoutNs)
+{
+	uint32_t toSubmit = *m_sqTail - loadAcquire(m_sqHead);
+	uint32_t flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+	struct __kernel_timespec ts;
+	struct io_uring_getevents_arg arg;
+	memset(&arg, 0, sizeof(arg));
+	const void* argPtr = nullptr;
+	size_t argSize = 0;
+
+	if(minComplete > 0 && timeoutNs > 0)
+	{
+		ts.tv_sec = timeoutNs / 1000000000LL;
+		ts.tv_nsec = timeoutNs % 1000000000LL;
+		arg.ts = reinterpret_cast<uint64_t>(&ts);
+		argPtr = &arg;
+		argSize = sizeof(arg);
+		flags |= IORING_ENTER_EXT_ARG;
+	}
+
+	int ret = ioUringEnter(m_ringFd, toSubmit, minComplete, flags, argPtr, argSize);
+	if(ret == -1)
+	{
+		// Timeout expired, or completions are about to be flushed from the overflow list: just nothing to return yet
+		if(errno == ETIME || errno == EBUSY || errno == EAGAIN)
+		{
+			return 0;
+		}
+		return -1;
+	}
+
+	return ret;
+}
+
+int EventLoopIoUringWrapper::reapCompletions(struct epoll_event* events, int maxEvents)
+{
+	int eventCount = 0;
+	uint32_t head = *m_cqHead;
+	uint32_t tail = loadAcquire(m_cqTail);
+
+	while(head != tail && eventCount < maxEvents)
+	{
+		const struct io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+		++head;
+
+		if(cqe.user_data == PollRemoveUserData)
+		{
+			continue;
+		}
+
+		int fd = static_cast<int>(cqe.user_data & 0xFFFFFFFFULL);
+		uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+		auto reg_it = m_registrations.find(fd);
+		if(reg_it == m_registrations.end() || reg_it->second.generation != generation)
+		{
+			// Completion of a poll request which has been removed or replaced in the meantime
+			continue;
+		}
+
+		Registration& registration = reg_it->second;
+		bool isMultishot = (registration.epollEvents & EPOLLET) && !(registration.epollEvents & EPOLLONESHOT);
+		bool hasMore = isMultishot && (cqe.flags & IORING_CQE_F_MORE);
+		registration.isArmed = hasMore;
+
+		if(cqe.res == -ECANCELED)
+		{
+			// Poll request was terminated by the kernel itself, silently arm a new one
+			(void)queuePollAdd(fd, registration);
+			continue;
+		}
+
+		events[eventCount].events = cqe.res < 0 ? static_cast<uint32_t>(EPOLLERR) : static_cast<uint32_t>(cqe.res);
+		events[eventCount].data = registration.data;
+		++eventCount;
+
+		if(cqe.res < 0)
+		{
+			// e.g. the FD has been closed without EPOLL_CTL_DEL, re-arming would only fail again
+			continue;
+		}
+
+		// Level-triggered FDs are re-armed right away, the request is submitted with the next wait, i.e. after the
+		// callback had a chance to consume the data. One-shot FDs stay disabled until EPOLL_CTL_MOD.
+		if(!hasMore && !(registration.epollEvents & EPOLLONESHOT))
+		{
+			(void)queuePollAdd(fd, registration);
+		}
+	}
+
+	storeRelease(m_cqHead, head);
+	return eventCount;
+}
+
+void EventLoopIoUringWrapper::unmapRing()
+{
+	if(m_sqes != nullptr)
+	{
+		munmap(m_sqes, m_sqesSize);
+		m_sqes = nullptr;
+	}
+
+	if(m_cqRingPtr != nullptr && m_cqRingPtr != m_sqRingPtr)
+	{
+		munmap(m_cqRingPtr, m_cqRingSize);
+	}
+	m_cqRingPtr = nullptr;
+
+	if(m_sqRingPtr != nullptr)
+	{
+		munmap(m_sqRingPtr, m_sqRingSize);
+		m_sqRingPtr = nullptr;
+	}
+}
+
+uint64_t EventLoopIoUringWrapper::makeUserData(int fd, uint32_t generation)
+{
+	return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
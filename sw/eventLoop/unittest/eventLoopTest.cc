@@ -1,18 +1,187 @@
 #include <iostream>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
 #include <sys/eventfd.h>
+#include <sys/socket.h>
 #include "eventLoopIf.h"
+#include "eventLoopGroupIf.h"
 
 using namespace UtilsFramework::EventLoop::V1;
 
+namespace
+{
+
+bool keepRescheduling = true;
+
+// Keeps the scheduled event queue busy forever, as long as keepRescheduling is set
+void rescheduleForever()
+{
+	if(keepRescheduling)
+	{
+		(void)IEventLoop::getThreadLocalInstance().scheduleEvent(rescheduleForever);
+	}
+}
+
+bool keepReposting = true;
+
+// Same with posted events
+void repostForever()
+{
+	if(keepReposting)
+	{
+		(void)IEventLoop::getThreadLocalInstance().post(repostForever);
+	}
+}
+
+// The callback never reads its FD, a one-shot FD is only reported again once rearmed
+bool checkOneShot(IEventLoop& eventLoop, const std::string& backendName)
+{
+	uint32_t modeCalls = 0;
+	uint32_t dispatched = 0;
+	uint64_t modeValue = 1;
+	int modeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	IEventLoop::ReturnCode rc = eventLoop.addFdHandler(modeFd, IEventLoop::FdEventIn | IEventLoop::FdModeOneShot, [&modeCalls](int, uint32_t)
+	{
+		++modeCalls;
+	});
+	(void)::write(modeFd, &modeValue, sizeof(modeValue));
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	uint32_t callsBeforeRearm = modeCalls;
+	IEventLoop::ReturnCode rearmRc = eventLoop.rearmFd(modeFd);
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	(void)eventLoop.removeFdHandler(modeFd);
+	::close(modeFd);
+	if(rc != IEventLoop::ReturnCode::NORMAL || callsBeforeRearm != 1 || rearmRc != IEventLoop::ReturnCode::NORMAL || modeCalls != 2)
+	{
+		std::cout << "[FAILED] - IEventLoop.rearmFd() on a one-shot FD" << backendName << ", calls before/after rearm = " << callsBeforeRearm << "/" << modeCalls << std::endl;
+		return false;
+	}
+
+	std::cout << "[PASSED] - IEventLoop.rearmFd() on a one-shot FD" << backendName << std::endl;
+	return true;
+}
+
+// The callback never reads its FD, an edge-triggered FD is only reported again once new data arrives
+bool checkEdgeTriggered(IEventLoop& eventLoop, const std::string& backendName)
+{
+	uint32_t modeCalls = 0;
+	uint32_t dispatched = 0;
+	uint64_t modeValue = 1;
+	int modeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	IEventLoop::ReturnCode rc = eventLoop.addFdHandler(modeFd, IEventLoop::FdEventIn | IEventLoop::FdModeEdgeTriggered, [&modeCalls](int, uint32_t)
+	{
+		++modeCalls;
+	});
+	(void)::write(modeFd, &modeValue, sizeof(modeValue));
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	uint32_t callsBeforeWrite = modeCalls;
+	(void)::write(modeFd, &modeValue, sizeof(modeValue));
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	(void)eventLoop.removeFdHandler(modeFd);
+	::close(modeFd);
+	if(rc != IEventLoop::ReturnCode::NORMAL || callsBeforeWrite != 1 || modeCalls != 2)
+	{
+		std::cout << "[FAILED] - IEventLoop.addFdHandler() edge-triggered" << backendName << ", calls before/after new data = " << callsBeforeWrite << "/" << modeCalls << std::endl;
+		return false;
+	}
+
+	std::cout << "[PASSED] - IEventLoop.addFdHandler() edge-triggered" << backendName << std::endl;
+	return true;
+}
+
+// Runs the FD handler cases on the io_uring backend of the calling thread's Event Loop, skipped if the kernel lacks it
+bool checkIoUringBackend()
+{
+	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
+	IEventLoop::ReturnCode rc = eventLoop.setBackend(IEventLoop::Backend::IoUring);
+	if(rc == IEventLoop::ReturnCode::INTERNAL_FAULT)
+	{
+		std::cout << "\tDEBUG: io_uring is not supported by this kernel, skipping its cases" << std::endl;
+		return true;
+	} else if(rc != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.setBackend() with io_uring" << std::endl;
+		return false;
+	}
+
+	// An event posted by another thread while the loop waits makes the FD readable, whose callback stops the loop
+	uint32_t calls = 0;
+	int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	rc = eventLoop.addFdHandler(fd, IEventLoop::FdEventIn, [&calls](int _fd, uint32_t) -> void
+	{
+		uint64_t counter;
+		(void)::read(_fd, &counter, sizeof(counter));
+		++calls;
+		IEventLoop::getThreadLocalInstance().stop();
+	});
+	IEventLoop::ReturnCode updateRc = eventLoop.updateFdEvents(fd, IEventLoop::FdEventIn);
+	IEventLoop::ReturnCode rearmRc = eventLoop.rearmFd(fd);
+	IEventLoop::ReturnCode postRc = IEventLoop::ReturnCode::INTERNAL_FAULT;
+	std::thread producer([&eventLoop, &postRc, fd]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		postRc = eventLoop.post([fd]()
+		{
+			uint64_t one = 1;
+			(void)::write(fd, &one, sizeof(one));
+		});
+	});
+	IEventLoop::ReturnCode runRc = eventLoop.run();
+	producer.join();
+	if(rc != IEventLoop::ReturnCode::NORMAL || updateRc != IEventLoop::ReturnCode::NORMAL || rearmRc != IEventLoop::ReturnCode::INVALID_ARG ||
+		runRc != IEventLoop::ReturnCode::NORMAL || postRc != IEventLoop::ReturnCode::NORMAL || calls != 1)
+	{
+		std::cout << "[FAILED] - IEventLoop.post() with io_uring" << std::endl;
+		return false;
+	}
+	std::cout << "[PASSED] - IEventLoop.post() with io_uring" << std::endl;
+
+	if(!checkOneShot(eventLoop, " with io_uring") || !checkEdgeTriggered(eventLoop, " with io_uring"))
+	{
+		return false;
+	}
+
+	// A removed FD is not reported anymore, even though it is readable
+	uint32_t dispatched = 0;
+	uint64_t one = 1;
+	rc = eventLoop.removeFdHandler(fd);
+	(void)::write(fd, &one, sizeof(one));
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	::close(fd);
+	if(rc != IEventLoop::ReturnCode::NORMAL || calls != 1)
+	{
+		std::cout << "[FAILED] - IEventLoop.removeFdHandler() with io_uring" << std::endl;
+		return false;
+	}
+
+	std::cout << "[PASSED] - IEventLoop.removeFdHandler() with io_uring" << std::endl;
+	return true;
+}
+
+}
+
 int main()
 {
 	IEventLoop& eventLoop = IEventLoop::getThreadLocalInstance();
 
 	int fd = eventfd(0, EFD_CLOEXEC);
 	uint32_t eventMask = IEventLoop::FdEventIn;
-	IEventLoop::CallbackFunc callback = [](int _fd, uint32_t _eventMask) -> void
+	auto callback = [](int _fd, uint32_t _eventMask) -> void
 	{
 		std::cout << "\tDEBUG: Call back for " << _fd << " is called with eventMask = " << +_eventMask << std::endl;
+
+		uint64_t counter;
+		(void)::read(_fd, &counter, sizeof(counter));
+		IEventLoop::getThreadLocalInstance().stop();
 	};
 
 
@@ -39,6 +208,52 @@ int main()
 	}
 
 
+	rc = eventLoop.rearmFd(fd);
+	if(rc != IEventLoop::ReturnCode::INVALID_ARG)
+	{
+		std::cout << "[FAILED] - IEventLoop.rearmFd() on a non one-shot FD" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.rearmFd()" << std::endl;
+	}
+
+
+	int exclusiveFd = eventfd(0, EFD_CLOEXEC);
+	rc = eventLoop.addFdHandler(exclusiveFd, IEventLoop::FdEventIn | IEventLoop::FdEventRdHup | IEventLoop::FdModeExclusive, callback);
+	if(rc != IEventLoop::ReturnCode::INVALID_ARG)
+	{
+		std::cout << "[FAILED] - IEventLoop.addFdHandler() with invalid FdModeExclusive mask" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addFdHandler() with invalid FdModeExclusive mask" << std::endl;
+	}
+	close(exclusiveFd);
+
+
+	rc = eventLoop.setEpollBatchSize(0, 8);
+	if(rc != IEventLoop::ReturnCode::INVALID_ARG)
+	{
+		std::cout << "[FAILED] - IEventLoop.setEpollBatchSize() with invalid range" << std::endl;
+		return -1;
+	}
+
+	rc = eventLoop.setEpollBatchSize(4, 64);
+	if(rc != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.setEpollBatchSize()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.setEpollBatchSize()" << std::endl;
+	}
+
+
+	// Make the FD readable so that run() can dispatch the callback, which then stops the loop
+	uint64_t one = 1;
+	(void)::write(fd, &one, sizeof(one));
+
 	rc = eventLoop.run();
 	if(rc != IEventLoop::ReturnCode::NORMAL)
 	{
@@ -50,11 +265,361 @@ int main()
 	}
 
 
-	IEventLoop::EventHandlerFunc evtFunc = []() -> void
+	IEventLoop::EpollStatistics stats = eventLoop.getEpollStatistics();
+	if(stats.epollWaitCalls != 1 || stats.wakeups != 1 || stats.readyEvents != 1 || stats.currentBatchSize != 4 ||
+		stats.epollCtlCalls != 1 || stats.coalescedUpdates != 1)
 	{
-		std::cout << "\tDEBUG: Executing EventHandlerFunc()!" << std::endl;
+		std::cout << "[FAILED] - IEventLoop.getEpollStatistics()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.getEpollStatistics()" << std::endl;
+	}
+
+
+	// The callbacks below never read their FD, so a level-triggered FD would be reported on every iteration
+	if(!checkOneShot(eventLoop, "") || !checkEdgeTriggered(eventLoop, ""))
+	{
+		return -1;
+	}
+
+
+	// Same cases on the io_uring backend, which can only be selected by an Event Loop without any FD yet
+	bool isIoUringOk = false;
+	std::thread ioUringThread([&isIoUringOk]()
+	{
+		isIoUringOk = checkIoUringBackend();
+	});
+	ioUringThread.join();
+	if(!isIoUringOk)
+	{
+		return -1;
+	}
+
+
+	// The callback makes its FD readable again once, so the second event is picked up while spinning
+	IEventLoop::BusyPollPolicy busyPollPolicy;
+	busyPollPolicy.spinTime = std::chrono::microseconds(100000);
+	busyPollPolicy.minPauses = 2;
+	busyPollPolicy.maxPauses = 1;
+	IEventLoop::ReturnCode invalidPolicyRc = eventLoop.setBusyPollPolicy(busyPollPolicy);
+	busyPollPolicy.maxPauses = 16;
+	rc = eventLoop.setBusyPollPolicy(busyPollPolicy);
+
+	int busyFd = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+	int busyEvents = 0;
+	(void)eventLoop.addFdHandler(busyFd, IEventLoop::FdEventIn, [&busyEvents](int _fd, uint32_t) -> void
+	{
+		uint64_t counter;
+		(void)::read(_fd, &counter, sizeof(counter));
+		if(++busyEvents == 1)
+		{
+			(void)::write(_fd, &counter, sizeof(counter));
+		} else
+		{
+			IEventLoop::getThreadLocalInstance().stop();
+		}
+	});
+	(void)eventLoop.run();
+	stats = eventLoop.getEpollStatistics();
+	(void)eventLoop.removeFdHandler(busyFd);
+	close(busyFd);
+	busyPollPolicy.spinTime = std::chrono::microseconds(0);
+	if(invalidPolicyRc != IEventLoop::ReturnCode::INVALID_ARG || rc != IEventLoop::ReturnCode::NORMAL || busyEvents != 2 ||
+		stats.busyPollHits != 1 || stats.busyPollSpinTimeUs != 100000 || eventLoop.setBusyPollPolicy(busyPollPolicy) != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.setBusyPollPolicy()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.setBusyPollPolicy()" << std::endl;
+	}
+
+
+	// runOnce() polls or waits for one batch, runUntil() keeps iterating until the deadline even without events
+	int pumpFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	(void)eventLoop.addFdHandler(pumpFd, IEventLoop::FdEventIn, [](int _fd, uint32_t) -> void
+	{
+		uint64_t counter;
+		(void)::read(_fd, &counter, sizeof(counter));
+	});
+	uint32_t emptyPoll = 1;
+	IEventLoop::ReturnCode pollRc = eventLoop.runOnce(std::chrono::nanoseconds(0), emptyPoll);
+	uint32_t pumped = 0;
+	(void)::write(pumpFd, &one, sizeof(one));
+	(void)eventLoop.post([]() -> void {});
+	rc = eventLoop.runOnce(std::chrono::microseconds(1500), pumped);
+	uint32_t idle = 1;
+	auto runStart = std::chrono::steady_clock::now();
+	IEventLoop::ReturnCode untilRc = eventLoop.runFor(std::chrono::microseconds(2500), idle);
+	auto runTime = std::chrono::steady_clock::now() - runStart;
+	(void)eventLoop.removeFdHandler(pumpFd);
+	close(pumpFd);
+	if(pollRc != IEventLoop::ReturnCode::NORMAL || emptyPoll != 0 || rc != IEventLoop::ReturnCode::NORMAL || pumped != 2 ||
+		untilRc != IEventLoop::ReturnCode::NORMAL || idle != 0 || runTime < std::chrono::microseconds(2500) || runTime > std::chrono::seconds(1))
+	{
+		std::cout << "[FAILED] - IEventLoop.runOnce()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.runOnce()" << std::endl;
+	}
+
+
+	// A batch is dispatched High, Normal then Low. The slow Normal callback uses up the low priority budget, so the
+	// edge-triggered Low FD is deferred to the next iteration
+	std::vector<int> priorityFds;
+	std::vector<int> dispatchOrder;
+	for(IEventLoop::FdPriority priority : {IEventLoop::FdPriority::Low, IEventLoop::FdPriority::Normal, IEventLoop::FdPriority::High})
+	{
+		int priorityFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		(void)eventLoop.addFdHandler(priorityFd, IEventLoop::FdEventIn | IEventLoop::FdModeEdgeTriggered, [&dispatchOrder, priority](int _fd, uint32_t) -> void
+		{
+			uint64_t counter;
+			(void)::read(_fd, &counter, sizeof(counter));
+			dispatchOrder.push_back(static_cast<int>(priority));
+			if(priority == IEventLoop::FdPriority::Normal && dispatchOrder.size() > 3)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		}, priority);
+		priorityFds.push_back(priorityFd);
+		(void)::write(priorityFd, &one, sizeof(one));
+	}
+	uint32_t firstBatch = 0;
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), firstBatch);
+	IEventLoop::ReturnCode budgetRc = eventLoop.setLowPriorityBudget(std::chrono::microseconds(1000));
+	for(int priorityFd : priorityFds)
+	{
+		(void)::write(priorityFd, &one, sizeof(one));
+	}
+	uint32_t overBudget = 0;
+	uint32_t deferred = 0;
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), overBudget);
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), deferred);
+	IEventLoop::EpollStatistics priorityStats = eventLoop.getEpollStatistics();
+	(void)eventLoop.setLowPriorityBudget(std::chrono::microseconds(0));
+	for(int priorityFd : priorityFds)
+	{
+		(void)eventLoop.removeFdHandler(priorityFd);
+		close(priorityFd);
+	}
+	std::vector<int> expectedOrder = {0, 1, 2, 0, 1, 2};
+	if(budgetRc != IEventLoop::ReturnCode::NORMAL || firstBatch != 3 || overBudget != 2 || deferred != 1 ||
+		dispatchOrder != expectedOrder || priorityStats.deferredEvents != 1)
+	{
+		std::cout << "[FAILED] - IEventLoop.addFdHandler() with FdPriority" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addFdHandler() with FdPriority" << std::endl;
+	}
+
+
+	// Toggling FdEventOut around every write ends up unchanged, no epoll_ctl() at all. The last update is applied
+	// before the next wait, so the eventfd is then reported writeable.
+	int toggleFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	uint32_t toggleEvents = 0;
+	(void)eventLoop.addFdHandler(toggleFd, IEventLoop::FdEventIn, [&toggleEvents](int, uint32_t _eventMask) -> void
+	{
+		toggleEvents |= _eventMask;
+	});
+	IEventLoop::EpollStatistics ctlStatsBefore = eventLoop.getEpollStatistics();
+	for(int i = 0; i < 3; ++i)
+	{
+		(void)eventLoop.updateFdEvents(toggleFd, IEventLoop::FdEventIn | IEventLoop::FdEventOut);
+		(void)eventLoop.updateFdEvents(toggleFd, IEventLoop::FdEventIn);
+	}
+	uint32_t toggled = 0;
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), toggled);
+	IEventLoop::EpollStatistics ctlStatsNoop = eventLoop.getEpollStatistics();
+	rc = eventLoop.updateFdEvents(toggleFd, IEventLoop::FdEventIn | IEventLoop::FdEventOut);
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), toggled);
+	IEventLoop::EpollStatistics ctlStatsAfter = eventLoop.getEpollStatistics();
+	(void)eventLoop.removeFdHandler(toggleFd);
+	close(toggleFd);
+	if(rc != IEventLoop::ReturnCode::NORMAL || ctlStatsNoop.epollCtlCalls != ctlStatsBefore.epollCtlCalls ||
+		ctlStatsNoop.coalescedUpdates != ctlStatsBefore.coalescedUpdates + 6 ||
+		ctlStatsAfter.epollCtlCalls != ctlStatsBefore.epollCtlCalls + 1 || toggled != 1 || toggleEvents != IEventLoop::FdEventOut)
+	{
+		std::cout << "[FAILED] - IEventLoop.updateFdEvents() coalescing" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.updateFdEvents() coalescing" << std::endl;
+	}
+
+
+	// Three ready FDs of a group are delivered by one group callback, after the callback of the ungrouped FD
+	std::vector<int> groupFds;
+	std::vector<int> groupCalls;
+	uint32_t groupId = 0;
+	IEventLoop::ReturnCode groupRc = eventLoop.addFdGroup([&groupCalls](const IEventLoop::FdEvent* events, size_t count) -> void
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			uint64_t counter;
+			(void)::read(events[i].fd, &counter, sizeof(counter));
+		}
+		groupCalls.push_back(static_cast<int>(count));
+	}, groupId);
+	int singleFd = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+	(void)eventLoop.addFdHandler(singleFd, IEventLoop::FdEventIn, [&groupCalls](int _fd, uint32_t) -> void
+	{
+		uint64_t counter;
+		(void)::read(_fd, &counter, sizeof(counter));
+		groupCalls.push_back(-1);
+	});
+	for(int i = 0; i < 3; ++i)
+	{
+		int groupFd = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+		rc = eventLoop.addFdToGroup(groupId, groupFd, IEventLoop::FdEventIn);
+		groupFds.push_back(groupFd);
+	}
+	uint32_t groupDispatched = 0;
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), groupDispatched);
+	IEventLoop::ReturnCode removeGroupRc = eventLoop.removeFdGroup(groupId);
+	IEventLoop::ReturnCode removedFdRc = eventLoop.removeFdHandler(groupFds[0]);
+	IEventLoop::ReturnCode missingGroupRc = eventLoop.addFdToGroup(groupId, groupFds[0], IEventLoop::FdEventIn);
+	(void)eventLoop.removeFdHandler(singleFd);
+	close(singleFd);
+	for(int groupFd : groupFds)
+	{
+		close(groupFd);
+	}
+	std::vector<int> expectedCalls = {-1, 3};
+	if(groupRc != IEventLoop::ReturnCode::NORMAL || rc != IEventLoop::ReturnCode::NORMAL || groupDispatched != 2 ||
+		groupCalls != expectedCalls || removeGroupRc != IEventLoop::ReturnCode::NORMAL ||
+		removedFdRc != IEventLoop::ReturnCode::NOT_FOUND || missingGroupRc != IEventLoop::ReturnCode::NOT_FOUND)
+	{
+		std::cout << "[FAILED] - IEventLoop.addFdGroup()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addFdGroup()" << std::endl;
+	}
+
+
+	// Both pending signals are read from the signalfd in one wakeup, the SIGUSR2 handler removes itself
+	std::vector<int> signals;
+	IEventLoop::ReturnCode usr1Rc = eventLoop.addSignalHandler(SIGUSR1, [&signals](const struct signalfd_siginfo& info) -> void
+	{
+		signals.push_back(static_cast<int>(info.ssi_signo));
+	});
+	rc = eventLoop.addSignalHandler(SIGUSR2, [&signals](const struct signalfd_siginfo& info) -> void
+	{
+		signals.push_back(static_cast<int>(info.ssi_signo));
+		(void)IEventLoop::getThreadLocalInstance().removeSignalHandler(SIGUSR2);
+		IEventLoop::getThreadLocalInstance().stop();
+	});
+	(void)raise(SIGUSR1);
+	(void)raise(SIGUSR2);
+	(void)eventLoop.run();
+	sigset_t blockedSignals;
+	IEventLoop::ReturnCode killRc = eventLoop.addSignalHandler(SIGKILL, [](const struct signalfd_siginfo&) -> void {});
+	IEventLoop::ReturnCode usr2Rc = eventLoop.removeSignalHandler(SIGUSR2);
+	IEventLoop::ReturnCode removeRc = eventLoop.removeSignalHandler(SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, nullptr, &blockedSignals);
+	if(usr1Rc != IEventLoop::ReturnCode::NORMAL || rc != IEventLoop::ReturnCode::NORMAL || signals.size() != 2 ||
+		signals[0] != SIGUSR1 || signals[1] != SIGUSR2 || killRc != IEventLoop::ReturnCode::INVALID_ARG ||
+		usr2Rc != IEventLoop::ReturnCode::NOT_FOUND || removeRc != IEventLoop::ReturnCode::NORMAL || sigismember(&blockedSignals, SIGUSR1))
+	{
+		std::cout << "[FAILED] - IEventLoop.addSignalHandler()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addSignalHandler()" << std::endl;
+	}
+
+
+	// 1 MiB is relayed from a pipe to a socket, the reader of the socket is slower than the writer of the pipe
+	constexpr size_t relaySize = 1 << 20;
+	int relayPipe[2];
+	int relaySockets[2];
+	(void)pipe2(relayPipe, O_CLOEXEC);
+	(void)socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, relaySockets);
+	(void)fcntl(relayPipe[0], F_SETFL, O_NONBLOCK);
+	(void)fcntl(relaySockets[0], F_SETFL, O_NONBLOCK);
+	std::thread relayWriter([&relayPipe, relaySize]()
+	{
+		std::vector<char> chunk(4096, 'r');
+		for(size_t written = 0; written < relaySize; written += chunk.size())
+		{
+			(void)::write(relayPipe[1], chunk.data(), chunk.size());
+		}
+		close(relayPipe[1]);
+	});
+	size_t received = 0;
+	std::thread relayReader([&relaySockets, &received]()
+	{
+		char chunk[1024];
+		ssize_t size;
+		while((size = ::read(relaySockets[1], chunk, sizeof(chunk))) > 0)
+		{
+			received += static_cast<size_t>(size);
+		}
+	});
+	int relayError = -1;
+	IEventLoop::RelayStatistics relayStats;
+	IEventLoop::ReturnCode blockingRc = eventLoop.addRelay(relayPipe[0], relaySockets[1]);
+	rc = eventLoop.addRelay(relayPipe[0], relaySockets[0], [&relayError, &relayStats](int, int error, const IEventLoop::RelayStatistics& statistics) -> void
+	{
+		relayError = error;
+		relayStats = statistics;
+		IEventLoop::getThreadLocalInstance().stop();
+	});
+	(void)eventLoop.run();
+	close(relaySockets[0]);
+	relayWriter.join();
+	relayReader.join();
+	close(relayPipe[0]);
+	close(relaySockets[1]);
+	if(blockingRc != IEventLoop::ReturnCode::INVALID_ARG || rc != IEventLoop::ReturnCode::NORMAL || relayError != 0 ||
+		relayStats.bytesRelayed != relaySize || received != relaySize || eventLoop.removeRelay(relayPipe[0]) != IEventLoop::ReturnCode::NOT_FOUND)
+	{
+		std::cout << "[FAILED] - IEventLoop.addRelay()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addRelay()" << std::endl;
+	}
+
+	// The reader of the sink is gone: the relay ends with EPIPE instead of SIGPIPE killing the process
+	(void)pipe2(relayPipe, O_CLOEXEC);
+	(void)socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, relaySockets);
+	(void)fcntl(relayPipe[0], F_SETFL, O_NONBLOCK);
+	(void)fcntl(relaySockets[0], F_SETFL, O_NONBLOCK);
+	close(relaySockets[1]);
+	(void)::write(relayPipe[1], "relay", 5);
+	relayError = -1;
+	rc = eventLoop.addRelay(relayPipe[0], relaySockets[0], [&relayError](int, int error, const IEventLoop::RelayStatistics&) -> void
+	{
+		relayError = error;
+		IEventLoop::getThreadLocalInstance().stop();
+	});
+	(void)eventLoop.run();
+	close(relayPipe[0]);
+	close(relayPipe[1]);
+	close(relaySockets[0]);
+	sigset_t pendingSignals;
+	sigpending(&pendingSignals);
+	if(rc != IEventLoop::ReturnCode::NORMAL || relayError != EPIPE || sigismember(&pendingSignals, SIGPIPE))
+	{
+		std::cout << "[FAILED] - IEventLoop.addRelay() to a closed peer" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.addRelay() to a closed peer" << std::endl;
+	}
+
+
+	// Event handlers are move-only, so they can own move-only captures
+	std::unique_ptr<int> evtValue(new int(1));
+	IEventLoop::EventHandlerFunc evtFunc = [evtValue = std::move(evtValue)]() -> void
+	{
+		std::cout << "\tDEBUG: Executing EventHandlerFunc() with value " << *evtValue << "!" << std::endl;
 	};
-	rc = eventLoop.scheduleEvent(evtFunc);
+	rc = eventLoop.scheduleEvent(std::move(evtFunc));
 	if(rc != IEventLoop::ReturnCode::NORMAL)
 	{
 		std::cout << "[FAILED] - IEventLoop.scheduleEvent()" << std::endl;
@@ -65,6 +630,89 @@ int main()
 	}
 
 
+	// With a budget of one event per iteration, only evtFunc runs before the FD callback stops the loop
+	(void)::write(fd, &one, sizeof(one));
+	(void)eventLoop.scheduleEvent(rescheduleForever);
+	rc = eventLoop.setScheduledEventBudget(1, std::chrono::microseconds(0));
+	IEventLoop::ReturnCode runRc = eventLoop.run();
+	stats = eventLoop.getEpollStatistics();
+	if(rc != IEventLoop::ReturnCode::NORMAL || runRc != IEventLoop::ReturnCode::NORMAL || stats.scheduledEvents != 1 || stats.scheduledBacklog != 1 ||
+		eventLoop.setScheduledEventBudget(0, std::chrono::microseconds(-1)) != IEventLoop::ReturnCode::INVALID_ARG ||
+		eventLoop.setScheduledEventBudget(0, std::chrono::microseconds(0)) != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.setScheduledEventBudget()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.setScheduledEventBudget()" << std::endl;
+	}
+
+
+	// An event posted by another thread makes the FD readable again, whose callback then stops the loop
+	IEventLoop::ReturnCode postRc = IEventLoop::ReturnCode::INTERNAL_FAULT;
+	std::thread producer([&eventLoop, &postRc, fd]()
+	{
+		postRc = eventLoop.post([fd]()
+		{
+			uint64_t one = 1;
+			(void)::write(fd, &one, sizeof(one));
+		});
+	});
+	// Every callback is slower than 1ns, so each of them is reported
+	uint64_t slowCallbacks = 0;
+	IEventLoop::InstrumentationSnapshot snapshot;
+	IEventLoop::ReturnCode instrumentationRc = eventLoop.getInstrumentationSnapshot(snapshot);
+	if(instrumentationRc == IEventLoop::ReturnCode::NOT_FOUND)
+	{
+		instrumentationRc = eventLoop.enableInstrumentation(std::chrono::nanoseconds(1), [&slowCallbacks](int, std::chrono::nanoseconds)
+		{
+			++slowCallbacks;
+		});
+	}
+
+	// rescheduleForever() is still busy in the background, it must not starve the FD
+	rc = eventLoop.run();
+	producer.join();
+	keepRescheduling = false;
+	if(rc != IEventLoop::ReturnCode::NORMAL || postRc != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.post()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.post()" << std::endl;
+	}
+
+
+	if(instrumentationRc != IEventLoop::ReturnCode::NORMAL || eventLoop.getInstrumentationSnapshot(snapshot) != IEventLoop::ReturnCode::NORMAL ||
+		snapshot.callbackLatency.count != 1 || snapshot.eventHandlerLatency.count == 0 || snapshot.eventsPerBatch.count == 0 ||
+		snapshot.slowCallbacks == 0 || snapshot.slowCallbacks != slowCallbacks || eventLoop.disableInstrumentation() != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.enableInstrumentation()" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.enableInstrumentation()" << std::endl;
+	}
+
+
+	// A posted event posting again to its own loop must not starve the FD, whose callback stops the loop
+	(void)::write(fd, &one, sizeof(one));
+	postRc = eventLoop.post(repostForever);
+	rc = eventLoop.run();
+	keepReposting = false;
+	uint32_t dispatched = 0;
+	(void)eventLoop.runOnce(std::chrono::nanoseconds(0), dispatched);
+	if(rc != IEventLoop::ReturnCode::NORMAL || postRc != IEventLoop::ReturnCode::NORMAL)
+	{
+		std::cout << "[FAILED] - IEventLoop.post() from a posted event" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoop.post() from a posted event" << std::endl;
+	}
+
+
 	rc = eventLoop.removeFdHandler(fd);
 	if(rc != IEventLoop::ReturnCode::NORMAL)
 	{
@@ -85,5 +733,43 @@ int main()
 		std::cout << "[PASSED] - IEventLoop.stop()" << std::endl;
 	}
 
+
+	// A group of 2 loops: a function posted to loop 1 makes the FD readable, whose callback then runs on its loop
+	IEventLoopGroup::Options groupOptions;
+	groupOptions.numLoops = 2;
+	auto group = IEventLoopGroup::create(groupOptions);
+	int groupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	std::atomic<int> groupEvents(0);
+	uint32_t groupLoopIndex = IEventLoopGroup::AnyLoop;
+	bool isGroupOk = group != nullptr && group->getNumLoops() == 2 &&
+		group->addFdHandler(groupFd, IEventLoop::FdEventIn, [&groupEvents](int _fd, uint32_t) -> void
+		{
+			uint64_t counter;
+			(void)::read(_fd, &counter, sizeof(counter));
+			++groupEvents;
+		}) == IEventLoop::ReturnCode::NORMAL &&
+		group->getLoopIndex(groupFd, groupLoopIndex) == IEventLoop::ReturnCode::NORMAL && groupLoopIndex < 2 &&
+		group->post([groupFd]()
+		{
+			uint64_t one = 1;
+			(void)::write(groupFd, &one, sizeof(one));
+		}, 1) == IEventLoop::ReturnCode::NORMAL;
+
+	for(int i = 0; isGroupOk && groupEvents == 0 && i < 1000; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	isGroupOk = isGroupOk && groupEvents == 1 && group->removeFdHandler(groupFd) == IEventLoop::ReturnCode::NORMAL;
+	group.reset();
+	close(groupFd);
+	if(!isGroupOk)
+	{
+		std::cout << "[FAILED] - IEventLoopGroup" << std::endl;
+		return -1;
+	} else
+	{
+		std::cout << "[PASSED] - IEventLoopGroup" << std::endl;
+	}
+
 	return 0;
 }
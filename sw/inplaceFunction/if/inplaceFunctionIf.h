@@ -0,0 +1,200 @@
+/*
+*        ________________           ________                                                    ______  
+* ____  ___  /___(_)__  /_______    ___  __/____________ _______ ___________      _________________  /__
+* _  / / /  __/_  /__  /__  ___/    __  /_ __  ___/  __ `/_  __ `__ \  _ \_ | /| / /  __ \_  ___/_  //_/
+* / /_/ // /_ _  / _  / _(__  )     _  __/ _  /   / /_/ /_  / / / / /  __/_ |/ |/ // /_/ /  /   _  ,<   
+* \__,_/ \__/ /_/  /_/  /____/      /_/    /_/    \__,_/ /_/ /_/ /_/\___/____/|__/ \____//_/    /_/|_|  
+*                                                                                                       
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <assert.h>
+
+/* Default size in bytes of the inline storage of InplaceFunction, i.e. the maximum size of a callable (lambda
+*  captures, bound arguments,...). It must be the same for all libraries and applications which share IEventLoop,
+*  IActiveObject or IItcPubSub objects, since the callback types of those interfaces depend on it. */
+#ifndef UF_INPLACE_FUNCTION_CAPACITY
+#define UF_INPLACE_FUNCTION_CAPACITY 64
+#endif
+
+namespace UtilsFramework
+{
+namespace InplaceFunction
+{
+namespace V1
+{
+
+/*! @brief A move-only replacement for std::function which never allocates memory. The callable is always stored in
+* a fixed-size buffer inside the InplaceFunction object itself, so passing a callback into an Event Loop or an
+* Active Object is only a copy of a few cache lines, and no malloc()/free() happens on the dispatch path.
+*
+* If a callable does not fit into the buffer, the compilation fails with a static_assert(). Then either capture less
+* (for example one pointer to a struct instead of many variables), or use a bigger Capacity for your own types:
+*
+* </code>
+*   InplaceFunction<void(int), 128> func = [bigCapture](int value) { ... };
+* </code>
+*
+* Unlike std::function, InplaceFunction cannot be copied. Any copyable callable can still be given as an lvalue,
+* the InplaceFunction then holds its own copy. An InplaceFunction lvalue must be given with std::move(). */
+template <typename Signature, size_t Capacity = UF_INPLACE_FUNCTION_CAPACITY>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+	InplaceFunction() noexcept = default;
+	InplaceFunction(std::nullptr_t) noexcept {}
+
+	template <typename F, typename Callable = std::decay_t<F>,
+	          typename = std::enable_if_t<!std::is_same<Callable, InplaceFunction>::value &&
+	                                      std::is_invocable_r<R, Callable&, Args...>::value>>
+	InplaceFunction(F&& func)
+	{
+		static_assert(sizeof(Callable) <= Capacity, "InplaceFunction - Callable is too big for the inline storage!");
+		static_assert(alignof(Callable) <= alignof(std::max_align_t), "InplaceFunction - Callable is over-aligned!");
+		static_assert(std::is_nothrow_move_constructible<Callable>::value, "InplaceFunction - Callable move may throw!");
+
+		// Same as std::function, a null function pointer results in an empty InplaceFunction
+		if constexpr (std::is_pointer<std::remove_reference_t<F>>::value || std::is_member_pointer<Callable>::value)
+		{
+			if(func == nullptr)
+			{
+				return;
+			}
+		}
+
+		::new (static_cast<void*>(&m_storage)) Callable(std::forward<F>(func));
+		m_operations = &CallableOperations<Callable>::operations;
+	}
+
+	InplaceFunction(InplaceFunction&& other) noexcept
+	{
+		moveFrom(other);
+	}
+
+	InplaceFunction& operator=(InplaceFunction&& other) noexcept
+	{
+		if(this != &other)
+		{
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction& operator=(std::nullptr_t) noexcept
+	{
+		reset();
+		return *this;
+	}
+
+	template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InplaceFunction>::value &&
+	                                                  std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+	InplaceFunction& operator=(F&& func)
+	{
+		return *this = InplaceFunction(std::forward<F>(func));
+	}
+
+	// Copying would need to copy the callable, which is exactly what InplaceFunction is meant to avoid
+	InplaceFunction(const InplaceFunction&)               = delete;
+	InplaceFunction& operator=(const InplaceFunction&)    = delete;
+
+	~InplaceFunction()
+	{
+		reset();
+	}
+
+	/*! @brief Same as std::function, invoking an empty InplaceFunction is a programming error */
+	R operator()(Args... args) const
+	{
+		assert(m_operations != nullptr);
+		return m_operations->invoke(&m_storage, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return m_operations != nullptr;
+	}
+
+	friend bool operator==(const InplaceFunction& func, std::nullptr_t) noexcept { return !func; }
+	friend bool operator==(std::nullptr_t, const InplaceFunction& func) noexcept { return !func; }
+	friend bool operator!=(const InplaceFunction& func, std::nullptr_t) noexcept { return static_cast<bool>(func); }
+	friend bool operator!=(std::nullptr_t, const InplaceFunction& func) noexcept { return static_cast<bool>(func); }
+
+	static constexpr size_t capacity = Capacity;
+
+private:
+	/* Type-erased operations of the stored callable, one static table per callable type */
+	struct Operations
+	{
+		R (*invoke)(void* storage, Args&&... args);
+		void (*move)(void* dst, void* src) noexcept;    /*!< Move-constructs dst from src, then destroys src */
+		void (*destroy)(void* storage) noexcept;
+	};
+
+	template <typename Callable>
+	struct CallableOperations
+	{
+		static R invoke(void* storage, Args&&... args)
+		{
+			if constexpr (std::is_void<R>::value)
+			{
+				std::invoke(*static_cast<Callable*>(storage), std::forward<Args>(args)...);
+			} else
+			{
+				return std::invoke(*static_cast<Callable*>(storage), std::forward<Args>(args)...);
+			}
+		}
+
+		static void move(void* dst, void* src) noexcept
+		{
+			Callable* callable = static_cast<Callable*>(src);
+			::new (dst) Callable(std::move(*callable));
+			callable->~Callable();
+		}
+
+		static void destroy(void* storage) noexcept
+		{
+			static_cast<Callable*>(storage)->~Callable();
+		}
+
+		static constexpr Operations operations = {&invoke, &move, &destroy};
+	};
+
+	void moveFrom(InplaceFunction& other) noexcept
+	{
+		if(other.m_operations)
+		{
+			other.m_operations->move(&m_storage, &other.m_storage);
+			m_operations = other.m_operations;
+			other.m_operations = nullptr;
+		}
+	}
+
+	void reset() noexcept
+	{
+		if(m_operations)
+		{
+			m_operations->destroy(&m_storage);
+			m_operations = nullptr;
+		}
+	}
+
+	const Operations* m_operations = nullptr;
+	mutable std::aligned_storage_t<Capacity, alignof(std::max_align_t)> m_storage;
+
+}; // class InplaceFunction
+
+} // namespace V1
+
+} // namespace InplaceFunction
+
+} // namespace UtilsFramework
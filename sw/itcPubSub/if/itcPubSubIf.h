@@ -10,9 +10,10 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
 #include <memory>
 
+#include "inplaceFunctionIf.h"
+
 union itc_msg;
 
 namespace UtilsFramework
@@ -77,10 +78,11 @@ public:
 
 	static IItcPubSub& getThreadLocalInstance();
 
-	using MsgHandler = std::function<void(const std::shared_ptr<union itc_msg>& msg)>;
+	/* Message handlers are stored inline without any heap allocation and are move-only, see InplaceFunction */
+	using MsgHandler = UtilsFramework::InplaceFunction::V1::InplaceFunction<void(const std::shared_ptr<union itc_msg>& msg)>;
 
 	virtual ReturnCode addItcFd(int fd) = 0;
-	virtual ReturnCode registerMsg(uint32_t msgNo, const MsgHandler& msgHandler) = 0;
+	virtual ReturnCode registerMsg(uint32_t msgNo, MsgHandler&& msgHandler) = 0;
 	virtual ReturnCode deregisterMsg(uint32_t msgNo) = 0;
 
 protected:
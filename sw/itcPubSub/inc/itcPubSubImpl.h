@@ -28,7 +28,7 @@ public:
 	static void reset();
 
 	ReturnCode addItcFd(int fd) override;
-	ReturnCode registerMsg(uint32_t msgNo, const MsgHandler& msgHandler) override;
+	ReturnCode registerMsg(uint32_t msgNo, MsgHandler&& msgHandler) override;
 	ReturnCode deregisterMsg(uint32_t msgNo) override;
 
 	ItcPubSubImpl();
@@ -1,11 +1,10 @@
 #include <iostream>
 #include <string>
+#include <functional>
 
 #include <itc.h>
-#include <stringUtils.h>
-#include <traceIf.h>
 
-#include "util_framework_tpt_provider.h"
+#include "util_framework_trace.h"
 #include "threadLocalIf.h"
 #include "eventLoopIf.h"
 #include "itcPubSubImpl.h"
@@ -79,13 +78,13 @@ IItcPubSub::ReturnCode ItcPubSubImpl::addItcFd(int fd)
 {
 	if(std::this_thread::get_id() != m_threadId)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("addItcFd - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "addItcFd - Not a thread local!");
 		return IItcPubSub::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
 	if(m_mboxFd != -1)
 	{
-		TPT_TRACE(TRACE_ABN, SSTR("addItcFd - FD ", fd, " handler already exists!"));
+		UF_TRACE(TRACE_ABN, "addItcFd - FD ", fd, " handler already exists!");
 		return IItcPubSub::ReturnCode::ALREADY_EXISTS;
 	}
 
@@ -93,34 +92,34 @@ IItcPubSub::ReturnCode ItcPubSubImpl::addItcFd(int fd)
 
 	if(IEventLoop::getThreadLocalInstance().addFdHandler(fd, IEventLoop::FdEventIn, callback) != IEventLoop::ReturnCode::NORMAL)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("addItcFd - Failed to IEventLoop::addFdHandler()!"));
+		UF_TRACE(TRACE_ERROR, "addItcFd - Failed to IEventLoop::addFdHandler()!");
 		return IItcPubSub::ReturnCode::INTERNAL_FAULT;
 	}
 
 	m_mboxFd = fd;
 
-	TPT_TRACE(TRACE_INFO, SSTR("addItcFd - Added Mailbox FD ", fd, " successfully!"));
+	UF_TRACE(TRACE_INFO, "addItcFd - Added Mailbox FD ", fd, " successfully!");
 	return IItcPubSub::ReturnCode::NORMAL;
 }
 
-IItcPubSub::ReturnCode ItcPubSubImpl::registerMsg(uint32_t msgNo, const MsgHandler& msgHandler)
+IItcPubSub::ReturnCode ItcPubSubImpl::registerMsg(uint32_t msgNo, MsgHandler&& msgHandler)
 {
 	if(std::this_thread::get_id() != m_threadId)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("registerMsg - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "registerMsg - Not a thread local!");
 		return IItcPubSub::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
 	auto it = m_msgHandlerMap.find(msgNo);
 	if(it != m_msgHandlerMap.end())
 	{
-		TPT_TRACE(TRACE_ABN, SSTR("registerMsg - Message number 0x", std::hex, msgNo," already registered!"));
+		UF_TRACE(TRACE_ABN, "registerMsg - Message number 0x", std::hex, msgNo," already registered!");
 		return IItcPubSub::ReturnCode::ALREADY_EXISTS;
 	}
 
-	m_msgHandlerMap.emplace(msgNo, msgHandler);
+	m_msgHandlerMap.emplace(msgNo, std::move(msgHandler));
 
-	TPT_TRACE(TRACE_INFO, SSTR("registerMsg - Registered message number 0x", std::hex, msgNo, " successfully!"));
+	UF_TRACE(TRACE_INFO, "registerMsg - Registered message number 0x", std::hex, msgNo, " successfully!");
 	return IItcPubSub::ReturnCode::NORMAL;
 }
 
@@ -128,20 +127,20 @@ IItcPubSub::ReturnCode ItcPubSubImpl::deregisterMsg(uint32_t msgNo)
 {
 	if(std::this_thread::get_id() != m_threadId)
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("deregisterMsg - Not a thread local!"));
+		UF_TRACE(TRACE_ERROR, "deregisterMsg - Not a thread local!");
 		return IItcPubSub::ReturnCode::NOT_THREAD_LOCAL;
 	}
 
 	auto it = m_msgHandlerMap.find(msgNo);
 	if(it == m_msgHandlerMap.end())
 	{
-		TPT_TRACE(TRACE_ABN, SSTR("deregisterMsg - Message number 0x", std::hex, msgNo," not found!"));
+		UF_TRACE(TRACE_ABN, "deregisterMsg - Message number 0x", std::hex, msgNo," not found!");
 		return IItcPubSub::ReturnCode::NOT_FOUND;
 	}
 
 	m_msgHandlerMap.erase(it);
 
-	TPT_TRACE(TRACE_INFO, SSTR("deregisterMsg - Deregistered message number 0x", std::hex, msgNo, " successfully!"));
+	UF_TRACE(TRACE_INFO, "deregisterMsg - Deregistered message number 0x", std::hex, msgNo, " successfully!");
 	return IItcPubSub::ReturnCode::NORMAL;
 }
 
@@ -163,8 +162,8 @@ void ItcPubSubImpl::handleFdEvent()
 			dispatchMsgHandler(it->second, itcMsg);
 		} else
 		{
-			TPT_TRACE(TRACE_ABN, SSTR("handleFdEvent - No message handler found for msgNo 0x", std::hex, itcMsg->msgNo, \
-			"sent from \"", getMboxName(itc_sender(itcMsg.get())), "\" to our mailbox \"", getMboxName(itc_current_mbox()), "\"!"));
+			UF_TRACE(TRACE_ABN, "handleFdEvent - No message handler found for msgNo 0x", std::hex, itcMsg->msgNo, \
+			"sent from \"", getMboxName(itc_sender(itcMsg.get())), "\" to our mailbox \"", getMboxName(itc_current_mbox()), "\"!");
 		}
 	}
 }
@@ -1,7 +1,4 @@
-#include <stringUtils.h>
-#include <traceIf.h>
-
-#include "util_framework_tpt_provider.h"
+#include "util_framework_trace.h"
 #include "startupRegistryImpl.h"
 #include "preparationPhaseResponderImpl.h"
 
@@ -50,7 +47,7 @@ bool StartupRegistryImpl::startAllModules(const std::chrono::seconds& startupTim
 		(startupModule->getModuleName(), std::chrono::steady_clock::now() + startupTimeout);
 		responderVec.push_back(responder);
 
-		TPT_TRACE(TRACE_INFO, SSTR("Preparing initialization for \"", responder->getModuleName(), "\""));
+		UF_TRACE(TRACE_INFO, "Preparing initialization for \"", responder->getModuleName(), "\"");
 		startupModule->prepare(responder);
 	}
 
@@ -60,17 +57,17 @@ bool StartupRegistryImpl::startAllModules(const std::chrono::seconds& startupTim
 		{
 			if(success)
 			{
-				TPT_TRACE(TRACE_INFO, SSTR("Prepared initialization for \"", resp->getModuleName(), "\" successfully!"));
+				UF_TRACE(TRACE_INFO, "Prepared initialization for \"", resp->getModuleName(), "\" successfully!");
 				result = true;
 			}
 			else
 			{
-				TPT_TRACE(TRACE_ERROR, SSTR("Failed to prepare initialization for \"", resp->getModuleName(), "\""));
+				UF_TRACE(TRACE_ERROR, "Failed to prepare initialization for \"", resp->getModuleName(), "\"");
 			}
 		}
 		else
 		{
-			TPT_TRACE(TRACE_ERROR, SSTR("Timeout when trying to prepare initialization for \"", resp->getModuleName(), "\", timeout = ", startupTimeout.count(), " seconds!"));
+			UF_TRACE(TRACE_ERROR, "Timeout when trying to prepare initialization for \"", resp->getModuleName(), "\", timeout = ", startupTimeout.count(), " seconds!");
 		}
 	}
 
@@ -78,7 +75,7 @@ bool StartupRegistryImpl::startAllModules(const std::chrono::seconds& startupTim
 	{
 		for(const auto& mod : m_startupModuleVec)
 		{
-			TPT_TRACE(TRACE_INFO, SSTR("Starting up \"", mod->getModuleName(), "\"..."));
+			UF_TRACE(TRACE_INFO, "Starting up \"", mod->getModuleName(), "\"...");
 			mod->start();
 		}
 	}
@@ -11,6 +11,8 @@
 
 #include <sys/timerfd.h>
 
+#include "threadCheckPolicy.h"
+
 namespace UtilsFramework
 {
 namespace Timer
@@ -41,6 +43,40 @@ public:
 
 }; // class TimerManagerSyscallWrapper
 
+/* How TimerManagerImpl makes its system calls, selected by UF_DIRECT_SYSCALLS (see threadCheckPolicy.h). The direct
+*  one calls the non-virtual base functions, which are inlined to the plain system calls. */
+struct WrappedTimerSyscalls
+{
+	static int timerFdCreate(TimerManagerSyscallWrapper& wrapper, int clockType, int flags)
+	{
+		return wrapper.timerFdCreate(clockType, flags);
+	}
+
+	static int timerFdSetTime(TimerManagerSyscallWrapper& wrapper, int fd, int flags, const struct itimerspec *new_value, struct itimerspec *old_value)
+	{
+		return wrapper.timerFdSetTime(fd, flags, new_value, old_value);
+	}
+};
+
+struct DirectTimerSyscalls
+{
+	static int timerFdCreate(TimerManagerSyscallWrapper& wrapper, int clockType, int flags)
+	{
+		return wrapper.TimerManagerSyscallWrapper::timerFdCreate(clockType, flags);
+	}
+
+	static int timerFdSetTime(TimerManagerSyscallWrapper& wrapper, int fd, int flags, const struct itimerspec *new_value, struct itimerspec *old_value)
+	{
+		return wrapper.TimerManagerSyscallWrapper::timerFdSetTime(fd, flags, new_value, old_value);
+	}
+};
+
+#if UF_DIRECT_SYSCALLS
+using TimerSyscalls = DirectTimerSyscalls;
+#else
+using TimerSyscalls = WrappedTimerSyscalls;
+#endif
+
 } // namespace V1
 
 } // namespace ActiveObject
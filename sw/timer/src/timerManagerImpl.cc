@@ -1,19 +1,18 @@
 #include <unistd.h>
 #include <cstring>
-
-#include <stringUtils.h>
-#include <traceIf.h>
+#include <functional>
 
 #include "timerManagerImpl.h"
 #include "timerManagerSyscallWrapper.h"
 #include "timerSubscriberIf.h"
 #include "eventLoopIf.h"
 #include "threadLocalIf.h"
-#include "util_framework_tpt_provider.h"
+#include "util_framework_trace.h"
 
 using namespace UtilsFramework::EventLoop::V1;
 using namespace UtilsFramework::ThreadLocal::V1;
 using namespace CommonUtils::V1::StringUtils;
+using namespace UtilsFramework::Common::V1;
 
 namespace UtilsFramework
 {
@@ -51,7 +50,7 @@ TimerManagerImpl::~TimerManagerImpl()
 		repossessTimerFd(m_timerFd);
 		close(m_timerFd);
 		(void)IEventLoop::getThreadLocalInstance().removeFdHandler(m_timerFd);
-		TPT_TRACE(TRACE_INFO, SSTR("TimerManagerImpl detructs successfully!"));
+		UF_TRACE(TRACE_INFO, "TimerManagerImpl detructs successfully!");
 	}
 }
 
@@ -62,7 +61,7 @@ ITimerManager::ReturnCode TimerManagerImpl::startTimer(const std::chrono::millis
 	tmoObj.subscriber = subscriber;
 	tmoObj.isPeriodical = false;
 
-	TPT_TRACE(TRACE_INFO, SSTR("Starting a timer, timeout = ", timeout.count(), "ms, userId = ", userId));
+	UF_TRACE(TRACE_INFO, "Starting a timer, timeout = ", timeout.count(), "ms, userId = ", userId);
 	return launchNewTimer(tmoObj, timeout);
 }
 
@@ -74,13 +73,13 @@ ITimerManager::ReturnCode TimerManagerImpl::startPeriodicalTimer(const std::chro
 	tmoObj.isPeriodical = false;
 	tmoObj.periodicalInterval = interval;
 
-	TPT_TRACE(TRACE_INFO, SSTR("Starting a periodical timer, interval = ", interval.count(), "ms, userId = ", userId));
+	UF_TRACE(TRACE_INFO, "Starting a periodical timer, interval = ", interval.count(), "ms, userId = ", userId);
 	return launchNewTimer(tmoObj, interval);
 }
 
 ITimerManager::ReturnCode TimerManagerImpl::cancelTimer(ITimerSubscriber *subscriber, uint32_t userId)
 {
-	if(std::this_thread::get_id() != m_threadId)
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
 		return ITimerManager::ReturnCode::NOT_THREAD_LOCAL;
 	}
@@ -90,7 +89,7 @@ ITimerManager::ReturnCode TimerManagerImpl::cancelTimer(ITimerSubscriber *subscr
 		if(iter->second.subscriber == subscriber && iter->second.userId == userId)
 		{
 			// Found one timer in the map, erase it
-			TPT_TRACE(TRACE_INFO, SSTR("Cancelling a timer, userId = ", userId));
+			UF_TRACE(TRACE_INFO, "Cancelling a timer, userId = ", userId);
 			auto next = m_activeTimers.erase(iter);
 			if(next == m_activeTimers.begin())
 			{
@@ -101,13 +100,13 @@ ITimerManager::ReturnCode TimerManagerImpl::cancelTimer(ITimerSubscriber *subscr
 		}
 	}
 
-	TPT_TRACE(TRACE_ABN, SSTR("Failed to cancel a timer (NOT_FOUND), userId = ", userId));
+	UF_TRACE(TRACE_ABN, "Failed to cancel a timer (NOT_FOUND), userId = ", userId);
 	return ITimerManager::ReturnCode::NOT_FOUND;
 }
 
 ITimerManager::ReturnCode TimerManagerImpl::launchNewTimer(const TimerObject& tmoObj, const std::chrono::milliseconds& timeout)
 {
-	if(std::this_thread::get_id() != m_threadId)
+	if(!ThreadCheckPolicy::isOwner(m_threadId))
 	{
 		return ITimerManager::ReturnCode::NOT_THREAD_LOCAL;
 	}
@@ -116,7 +115,7 @@ ITimerManager::ReturnCode TimerManagerImpl::launchNewTimer(const TimerObject& tm
 	{
 		if(iter->second.subscriber == tmoObj.subscriber && iter->second.userId == tmoObj.userId)
 		{
-			TPT_TRACE(TRACE_ABN, SSTR("Launching a new timer failed (ALREADY_EXISTS), timeout = ", timeout.count(), "ms, userId = ", tmoObj.userId));
+			UF_TRACE(TRACE_ABN, "Launching a new timer failed (ALREADY_EXISTS), timeout = ", timeout.count(), "ms, userId = ", tmoObj.userId);
 			return ITimerManager::ReturnCode::ALREADY_EXISTS;
 		}
 	}
@@ -126,7 +125,7 @@ ITimerManager::ReturnCode TimerManagerImpl::launchNewTimer(const TimerObject& tm
 		m_timerFd = createTimerFd();
 		if(m_timerFd == -1)
 		{
-			TPT_TRACE(TRACE_ERROR, SSTR("Launching a new timer failed, could not create timer fd!"));
+			UF_TRACE(TRACE_ERROR, "Launching a new timer failed, could not create timer fd!");
 			return ITimerManager::ReturnCode::INTERNAL_FAULT;
 		}
 	}
@@ -139,18 +138,18 @@ ITimerManager::ReturnCode TimerManagerImpl::launchNewTimer(const TimerObject& tm
 		if(!setTimerFd(m_timerFd))
 		{
 			m_activeTimers.erase(expiredDate);
-			TPT_TRACE(TRACE_ERROR, SSTR("Launching a new timer failed, could not pre-start the first timer!"));
+			UF_TRACE(TRACE_ERROR, "Launching a new timer failed, could not pre-start the first timer!");
 			return ITimerManager::ReturnCode::INTERNAL_FAULT;
 		}
 	}
 
-	TPT_TRACE(TRACE_INFO, SSTR("Launching a new timer successfully, timeout = ", timeout.count(), "ms, userId = ", tmoObj.userId));
+	UF_TRACE(TRACE_INFO, "Launching a new timer successfully, timeout = ", timeout.count(), "ms, userId = ", tmoObj.userId);
 	return ITimerManager::ReturnCode::NORMAL;
 }
 
 int TimerManagerImpl::createTimerFd()
 {
-	int fd = m_syscallWrapper->timerFdCreate(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	int fd = TimerSyscalls::timerFdCreate(*m_syscallWrapper, CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
 	if(fd != -1)
 	{
 		repossessTimerFd(fd);
@@ -164,7 +163,7 @@ int TimerManagerImpl::createTimerFd()
 	}
 	else
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("Failed to create a new timer FD!"));
+		UF_TRACE(TRACE_ERROR, "Failed to create a new timer FD!");
 	}
 
 	return fd;
@@ -184,15 +183,15 @@ bool TimerManagerImpl::setTimerFd(int fd)
 		its.it_value.tv_sec = seconds.time_since_epoch().count();
 		its.it_value.tv_nsec = nanoSeconds.count();
 
-		if(m_syscallWrapper->timerFdSetTime(fd, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
+		if(TimerSyscalls::timerFdSetTime(*m_syscallWrapper, fd, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
 		{
-			TPT_TRACE(TRACE_ERROR, SSTR("Failed to set time for timer FD = ", fd, "!"));
+			UF_TRACE(TRACE_ERROR, "Failed to set time for timer FD = ", fd, "!");
 			return false;
 		}
 	}
 	else
 	{
-		TPT_TRACE(TRACE_INFO, SSTR("No timers available in TimerManagerImpl!"));
+		UF_TRACE(TRACE_INFO, "No timers available in TimerManagerImpl!");
 		repossessTimerFd(fd);
 	}
 
@@ -203,7 +202,7 @@ void TimerManagerImpl::repossessTimerFd(int fd)
 {
 	struct itimerspec its;
 	std::memset(&its, 0, sizeof(struct itimerspec));
-	(void)m_syscallWrapper->timerFdSetTime(fd, TFD_TIMER_ABSTIME, &its, nullptr);
+	(void)TimerSyscalls::timerFdSetTime(*m_syscallWrapper, fd, TFD_TIMER_ABSTIME, &its, nullptr);
 }
 
 void TimerManagerImpl::onTimerExpired()
@@ -216,7 +215,7 @@ void TimerManagerImpl::onTimerExpired()
 		Maybe an already expired timer has been cancelled by another FD event in the same epoll event batch. */
 		if(errno != EAGAIN)
 		{
-			TPT_TRACE(TRACE_ERROR, SSTR("Failed to read(), errno = ", errno, "!"));
+			UF_TRACE(TRACE_ERROR, "Failed to read(), errno = ", errno, "!");
 		}
 		return;
 	}
@@ -244,7 +243,7 @@ void TimerManagerImpl::onTimerExpired()
 	}
 	else
 	{
-		TPT_TRACE(TRACE_ERROR, SSTR("Timer FD has been triggered but no expired timer found!"));
+		UF_TRACE(TRACE_ERROR, "Timer FD has been triggered but no expired timer found!");
 	}
 }
 